@@ -0,0 +1,325 @@
+/**
+ * @file        agent_client.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "agent_client.h"
+
+#include <agent/agent_messages.h>
+
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+std::mutex AgentClient::m_clientsLock;
+std::map<std::string, std::shared_ptr<AgentClient>> AgentClient::m_clients;
+
+/**
+ * @brief get the connection to an agent. All requests to the same agent share one connection,
+ *        which is created with the first request. A lost connection is replaced by a new one,
+ *        where the old client is deleted together with its receive-thread, when the last
+ *        request, which still uses it, is finished.
+ *
+ * @param address address of the agent (tcp:<host>:<port> or unix:<path>)
+ * @param errorMessage reference for error-message
+ *
+ * @return pointer to the client, or nullptr, if connecting failed
+ */
+std::shared_ptr<AgentClient>
+AgentClient::getClient(const std::string &address,
+                       std::string &errorMessage)
+{
+    std::lock_guard<std::mutex> guard(m_clientsLock);
+
+    std::map<std::string, std::shared_ptr<AgentClient>>::iterator it;
+    it = m_clients.find(address);
+    if(it != m_clients.end())
+    {
+        if(it->second->m_connectionLost == false) {
+            return it->second;
+        }
+
+        m_clients.erase(it);
+    }
+
+    const int socket = connectToAgent(address, errorMessage);
+    if(socket < 0) {
+        return nullptr;
+    }
+
+    std::shared_ptr<AgentClient> client(new AgentClient(address, socket));
+    m_clients.insert(std::make_pair(address, client));
+
+    return client;
+}
+
+/**
+ * @brief constructor
+ *
+ * @param address address of the agent
+ * @param socket connected socket
+ */
+AgentClient::AgentClient(const std::string &address,
+                         const int socket)
+    : m_address(address),
+      m_socket(socket)
+{
+    m_connectionLost = false;
+    m_receiveThread = new std::thread(&AgentClient::receiveResponses, this);
+}
+
+/**
+ * @brief destructor
+ */
+AgentClient::~AgentClient()
+{
+    shutdown(m_socket, SHUT_RDWR);
+    m_receiveThread->join();
+    delete m_receiveThread;
+    close(m_socket);
+}
+
+/**
+ * @brief create connection to an agent
+ *
+ * @param address address of the agent (tcp:<host>:<port> or unix:<path>)
+ * @param errorMessage reference for error-message
+ *
+ * @return connected socket or -1, if connecting failed
+ */
+int
+AgentClient::connectToAgent(const std::string &address,
+                            std::string &errorMessage)
+{
+    std::string socketType = "";
+    std::string host = "";
+    std::string port = "";
+    if(parseAgentAddress(address, socketType, host, port) == false)
+    {
+        errorMessage = "invalid agent-address: " + address;
+        return -1;
+    }
+
+    int connectedSocket = -1;
+    if(socketType == "unix")
+    {
+        struct sockaddr_un socketAddr;
+        memset(&socketAddr, 0, sizeof(socketAddr));
+        socketAddr.sun_family = AF_UNIX;
+        strncpy(socketAddr.sun_path, host.c_str(), sizeof(socketAddr.sun_path) - 1);
+
+        connectedSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(connectedSocket >= 0
+                && connect(connectedSocket,
+                           (struct sockaddr*)&socketAddr,
+                           sizeof(socketAddr)) < 0)
+        {
+            close(connectedSocket);
+            connectedSocket = -1;
+        }
+    }
+    else
+    {
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+
+        struct addrinfo* addrResult = nullptr;
+        if(getaddrinfo(host.c_str(), port.c_str(), &hints, &addrResult) != 0)
+        {
+            errorMessage = "failed to resolve address " + address;
+            return -1;
+        }
+
+        connectedSocket = socket(addrResult->ai_family, SOCK_STREAM, 0);
+        if(connectedSocket >= 0
+                && connect(connectedSocket, addrResult->ai_addr, addrResult->ai_addrlen) < 0)
+        {
+            close(connectedSocket);
+            connectedSocket = -1;
+        }
+        freeaddrinfo(addrResult);
+
+        // disable nagle-algorithm, because the messages are small and latency is important
+        if(connectedSocket >= 0)
+        {
+            const int flag = 1;
+            setsockopt(connectedSocket, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+        }
+    }
+
+    if(connectedSocket < 0)
+    {
+        errorMessage = "failed to connect to agent " + address;
+        return -1;
+    }
+
+    // authenticate with the shared token, before any blossom-request is sent
+    AgentMessageHeader header;
+    header.type = AUTH_REQUEST_TYPE;
+    std::string payload = "";
+    if(sendAgentMessage(connectedSocket, header, getAgentToken()) == false
+            || recvAgentMessage(connectedSocket,
+                                header,
+                                payload,
+                                AGENT_MAX_AUTH_PAYLOAD_SIZE) == false
+            || header.type != AUTH_RESPONSE_TYPE
+            || header.success == 0)
+    {
+        close(connectedSocket);
+        errorMessage = "agent " + address + " rejected the connection: " + payload;
+        return -1;
+    }
+
+    return connectedSocket;
+}
+
+/**
+ * @brief send a blossom-request to the agent and wait for the response. Multiple threads can
+ *        use this at the same time, so many requests are in flight over the same connection.
+ *
+ * @param group group of the blossom
+ * @param type type of the blossom
+ * @param input input-values of the blossom
+ * @param output reference for the output-values of the blossom
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+AgentClient::runBlossom(const std::string &group,
+                        const std::string &type,
+                        const DataMap &input,
+                        DataMap &output,
+                        std::string &errorMessage)
+{
+    std::string payload = group;
+    payload.push_back('\0');
+    payload += type;
+    payload.push_back('\0');
+    payload += input.toString();
+
+    PendingRequest request;
+    AgentMessageHeader header;
+    header.type = BLOSSOM_REQUEST_TYPE;
+
+    // register request before sending, because the response can come back very fast
+    {
+        std::lock_guard<std::mutex> guard(m_pendingLock);
+        if(m_connectionLost)
+        {
+            errorMessage = "connection to agent " + m_address + " was lost";
+            return false;
+        }
+
+        header.requestId = m_nextRequestId;
+        m_nextRequestId++;
+        m_pendingRequests.insert(std::make_pair(header.requestId, &request));
+    }
+
+    bool sendResult = false;
+    {
+        std::lock_guard<std::mutex> guard(m_writeLock);
+        sendResult = sendAgentMessage(m_socket, header, payload);
+    }
+
+    // wait for response
+    {
+        std::unique_lock<std::mutex> lock(m_pendingLock);
+        if(sendResult)
+        {
+            request.responseCv.wait(lock, [this, &request] {
+                return request.finished || m_connectionLost;
+            });
+        }
+        m_pendingRequests.erase(header.requestId);
+    }
+
+    if(request.finished == false)
+    {
+        errorMessage = "connection to agent " + m_address + " was lost";
+        return false;
+    }
+
+    if(request.success == false)
+    {
+        errorMessage = request.payload;
+        return false;
+    }
+
+    // convert output-values
+    JsonItem outputItem;
+    if(outputItem.parse(request.payload, errorMessage) == false) {
+        return false;
+    }
+
+    DataItem* content = outputItem.getItemContent();
+    if(content != nullptr
+            && content->isMap())
+    {
+        output = *content->toMap();
+    }
+
+    return true;
+}
+
+/**
+ * @brief loop of the receive-thread to hand over the incoming responses to the waiting
+ *        requests
+ */
+void
+AgentClient::receiveResponses()
+{
+    AgentMessageHeader header;
+    std::string payload;
+
+    while(recvAgentMessage(m_socket, header, payload))
+    {
+        std::lock_guard<std::mutex> guard(m_pendingLock);
+
+        std::map<uint32_t, PendingRequest*>::iterator it;
+        it = m_pendingRequests.find(header.requestId);
+        if(it == m_pendingRequests.end()) {
+            continue;
+        }
+
+        it->second->success = header.success != 0;
+        it->second->payload = payload;
+        it->second->finished = true;
+        it->second->responseCv.notify_one();
+    }
+
+    // wake up all waiting requests, because there will come no more responses
+    std::lock_guard<std::mutex> guard(m_pendingLock);
+    m_connectionLost = true;
+
+    std::map<uint32_t, PendingRequest*>::iterator it;
+    for(it = m_pendingRequests.begin();
+        it != m_pendingRequests.end();
+        it++)
+    {
+        it->second->responseCv.notify_one();
+    }
+}
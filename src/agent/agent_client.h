@@ -0,0 +1,73 @@
+/**
+ * @file        agent_client.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef AGENT_CLIENT_H
+#define AGENT_CLIENT_H
+
+#include <common.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+
+class AgentClient
+{
+public:
+    static std::shared_ptr<AgentClient> getClient(const std::string &address,
+                                                  std::string &errorMessage);
+    ~AgentClient();
+
+    bool runBlossom(const std::string &group,
+                    const std::string &type,
+                    const DataMap &input,
+                    DataMap &output,
+                    std::string &errorMessage);
+
+private:
+    struct PendingRequest
+    {
+        bool finished = false;
+        bool success = false;
+        std::string payload = "";
+        std::condition_variable responseCv;
+    };
+
+    static std::mutex m_clientsLock;
+    static std::map<std::string, std::shared_ptr<AgentClient>> m_clients;
+
+    AgentClient(const std::string &address, const int socket);
+
+    const std::string m_address;
+    const int m_socket;
+    std::thread* m_receiveThread = nullptr;
+    std::atomic<bool> m_connectionLost;
+
+    uint32_t m_nextRequestId = 0;
+    std::map<uint32_t, PendingRequest*> m_pendingRequests;
+    std::mutex m_pendingLock;
+    std::mutex m_writeLock;
+
+    static int connectToAgent(const std::string &address, std::string &errorMessage);
+    void receiveResponses();
+};
+
+#endif // AGENT_CLIENT_H
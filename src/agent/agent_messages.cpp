@@ -0,0 +1,287 @@
+/**
+ * @file        agent_messages.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "agent_messages.h"
+
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+static std::mutex agentTokenLock;
+static std::string agentToken = "";
+
+/**
+ * @brief set the shared token, which is required by the agent and sent by the controller
+ *
+ * @param token new token
+ */
+void
+setAgentToken(const std::string &token)
+{
+    std::lock_guard<std::mutex> guard(agentTokenLock);
+    agentToken = token;
+}
+
+/**
+ * @brief get the shared token of agent and controller
+ *
+ * @return token or empty string, if not set
+ */
+const std::string
+getAgentToken()
+{
+    std::lock_guard<std::mutex> guard(agentTokenLock);
+    return agentToken;
+}
+
+/**
+ * @brief compare two tokens in constant time, so the time of a failed comparison doesn't tell
+ *        how many characters of a guessed token were correct
+ *
+ * @param first first token
+ * @param second second token
+ *
+ * @return true, if equal, else false
+ */
+bool
+compareAgentTokens(const std::string &first,
+                   const std::string &second)
+{
+    if(first.size() != second.size()) {
+        return false;
+    }
+
+    uint8_t diff = 0;
+    for(uint64_t i = 0; i < first.size(); i++) {
+        diff |= static_cast<uint8_t>(first[i] ^ second[i]);
+    }
+
+    return diff == 0;
+}
+
+/**
+ * @brief check if a socket-address belongs to the loopback-interface
+ *
+ * @param address address to check
+ *
+ * @return true, if loopback, else false
+ */
+bool
+isLoopbackAddress(const struct sockaddr* address)
+{
+    if(address->sa_family == AF_INET)
+    {
+        const struct sockaddr_in* ipv4 = reinterpret_cast<const struct sockaddr_in*>(address);
+        return (ntohl(ipv4->sin_addr.s_addr) >> 24) == 127;
+    }
+
+    if(address->sa_family == AF_INET6)
+    {
+        const struct sockaddr_in6* ipv6 = reinterpret_cast<const struct sockaddr_in6*>(address);
+        return IN6_IS_ADDR_LOOPBACK(&ipv6->sin6_addr);
+    }
+
+    return false;
+}
+
+/**
+ * @brief split an agent-address like "tcp:127.0.0.1:7101" or "unix:/tmp/agent.sock"
+ *
+ * @param address address to split
+ * @param socketType reference for the type of the socket (tcp or unix)
+ * @param host reference for the host or the path of the unix-socket
+ * @param port reference for the port (empty for unix-sockets)
+ *
+ * @return false, if address is invalid, else true
+ */
+bool
+parseAgentAddress(const std::string &address,
+                  std::string &socketType,
+                  std::string &host,
+                  std::string &port)
+{
+    const size_t typeEnd = address.find(':');
+    if(typeEnd == std::string::npos) {
+        return false;
+    }
+
+    socketType = address.substr(0, typeEnd);
+    if(socketType == "unix")
+    {
+        host = address.substr(typeEnd + 1);
+        port = "";
+        return host != "";
+    }
+
+    if(socketType == "tcp")
+    {
+        const size_t portStart = address.rfind(':');
+        if(portStart == typeEnd) {
+            return false;
+        }
+
+        host = address.substr(typeEnd + 1, portStart - typeEnd - 1);
+        port = address.substr(portStart + 1);
+        return host != "" && port != "";
+    }
+
+    return false;
+}
+
+/**
+ * @brief send a message with header and payload with only one syscall. MSG_NOSIGNAL is used,
+ *        so a closed connection only fails the send and doesn't kill the process by SIGPIPE
+ *
+ * @param socket socket to write into
+ * @param header header of the message
+ * @param payload payload of the message
+ *
+ * @return false, if sending failed, else true
+ */
+bool
+sendAgentMessage(const int socket,
+                 const AgentMessageHeader &header,
+                 const std::string &payload)
+{
+    AgentMessageHeader sendHeader = header;
+    sendHeader.payloadSize = static_cast<uint32_t>(payload.size());
+
+    struct iovec parts[2];
+    parts[0].iov_base = &sendHeader;
+    parts[0].iov_len = sizeof(AgentMessageHeader);
+    parts[1].iov_base = const_cast<char*>(payload.c_str());
+    parts[1].iov_len = payload.size();
+
+    size_t totalSize = parts[0].iov_len + parts[1].iov_len;
+    int partPos = 0;
+    while(totalSize > 0)
+    {
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = &parts[partPos];
+        message.msg_iovlen = static_cast<size_t>(2 - partPos);
+
+        const ssize_t ret = sendmsg(socket, &message, MSG_NOSIGNAL);
+        if(ret < 0)
+        {
+            if(errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        // move forward within the parts in case of partial writes
+        size_t written = static_cast<size_t>(ret);
+        totalSize -= written;
+        while(partPos < 2
+              && written >= parts[partPos].iov_len)
+        {
+            written -= parts[partPos].iov_len;
+            partPos++;
+        }
+        if(partPos < 2)
+        {
+            parts[partPos].iov_base = static_cast<uint8_t*>(parts[partPos].iov_base) + written;
+            parts[partPos].iov_len -= written;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief read a specific number of bytes from a socket
+ *
+ * @param socket socket to read from
+ * @param buffer buffer to write the read data into
+ * @param size number of bytes to read
+ *
+ * @return false, if socket was closed or failed, else true
+ */
+bool
+recvComplete(const int socket,
+             void* buffer,
+             const size_t size)
+{
+    size_t pos = 0;
+    while(pos < size)
+    {
+        const ssize_t ret = recv(socket, static_cast<uint8_t*>(buffer) + pos, size - pos, 0);
+        if(ret < 0
+                && errno == EINTR)
+        {
+            continue;
+        }
+        if(ret <= 0) {
+            return false;
+        }
+
+        pos += static_cast<size_t>(ret);
+    }
+
+    return true;
+}
+
+/**
+ * @brief read the next message from a socket
+ *
+ * @param socket socket to read from
+ * @param header reference for the header of the message
+ * @param payload reference for the payload of the message
+ * @param maxPayloadSize maximum accepted payload-size, to not allocate memory for any size,
+ *                       which is claimed by the peer
+ *
+ * @return false, if socket was closed or the message was invalid, else true
+ */
+bool
+recvAgentMessage(const int socket,
+                 AgentMessageHeader &header,
+                 std::string &payload,
+                 const uint32_t maxPayloadSize)
+{
+    if(recvComplete(socket, &header, sizeof(AgentMessageHeader)) == false) {
+        return false;
+    }
+
+    if(header.magic != AGENT_MESSAGE_MAGIC)
+    {
+        LOG_ERROR("received invalid message from agent-connection");
+        return false;
+    }
+
+    if(header.payloadSize > maxPayloadSize)
+    {
+        LOG_ERROR("received message with too big payload from agent-connection: "
+                  + std::to_string(header.payloadSize) + " bytes");
+        return false;
+    }
+
+    payload.resize(header.payloadSize);
+    if(header.payloadSize == 0) {
+        return true;
+    }
+
+    return recvComplete(socket, &payload[0], header.payloadSize);
+}
@@ -0,0 +1,86 @@
+/**
+ * @file        agent_messages.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef AGENT_MESSAGES_H
+#define AGENT_MESSAGES_H
+
+#include <common.h>
+
+#define AGENT_MESSAGE_MAGIC 0x41524B53
+
+// limits for the payload of received messages; before the token is verified, only the small
+// auth-request is accepted
+#define AGENT_MAX_PAYLOAD_SIZE (64 * 1024 * 1024)
+#define AGENT_MAX_AUTH_PAYLOAD_SIZE 4096
+
+// maximum number of connections, which are handled by an agent at the same time
+#define AGENT_MAX_CONNECTIONS 64
+
+enum AgentMessageType
+{
+    UNDEFINED_MESSAGE_TYPE = 0,
+    BLOSSOM_REQUEST_TYPE = 1,
+    BLOSSOM_RESPONSE_TYPE = 2,
+    AUTH_REQUEST_TYPE = 3,
+    AUTH_RESPONSE_TYPE = 4,
+};
+
+/**
+ * @brief Header of each message between controller and agent. The payload directly follows
+ *        the header. The first message of each connection must be an auth-request, which is
+ *        answered by an auth-response, before any blossom-request is accepted.
+ *
+ *        auth-request-payload:  <shared token>
+ *        auth-response-payload: empty or <error-message>, if success is 0
+ *        request-payload:       <group>\0<type>\0<input-values as json>
+ *        response-payload:      <output-values as json> or <error-message>, if success is 0
+ */
+struct AgentMessageHeader
+{
+    uint32_t magic = AGENT_MESSAGE_MAGIC;
+    uint8_t type = UNDEFINED_MESSAGE_TYPE;
+    uint8_t success = 0;
+    uint16_t padding = 0;
+    uint32_t requestId = 0;
+    uint32_t payloadSize = 0;
+};
+static_assert(sizeof(AgentMessageHeader) == 16, "unexpected size of the agent-message-header");
+
+void setAgentToken(const std::string &token);
+const std::string getAgentToken();
+bool compareAgentTokens(const std::string &first, const std::string &second);
+bool isLoopbackAddress(const struct sockaddr* address);
+
+bool parseAgentAddress(const std::string &address,
+                       std::string &socketType,
+                       std::string &host,
+                       std::string &port);
+bool sendAgentMessage(const int socket,
+                      const AgentMessageHeader &header,
+                      const std::string &payload);
+bool recvAgentMessage(const int socket,
+                      AgentMessageHeader &header,
+                      std::string &payload,
+                      const uint32_t maxPayloadSize = AGENT_MAX_PAYLOAD_SIZE);
+
+#endif // AGENT_MESSAGES_H
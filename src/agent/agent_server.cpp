@@ -0,0 +1,366 @@
+/**
+ * @file        agent_server.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "agent_server.h"
+
+#include <sakura_root.h>
+#include <agent/agent_messages.h>
+#include <caches/ini_cache.h>
+#include <processing/thread_pool.h>
+
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+/**
+ * @brief constructor
+ */
+AgentServer::AgentServer() {}
+
+/**
+ * @brief destructor
+ */
+AgentServer::~AgentServer()
+{
+    if(m_serverSocket >= 0) {
+        close(m_serverSocket);
+    }
+}
+
+/**
+ * @brief close socket, when the last pending request of the connection is finished
+ */
+AgentServer::Connection::~Connection()
+{
+    if(socket >= 0) {
+        close(socket);
+    }
+}
+
+/**
+ * @brief create socket and accept incoming connections from controllers, until the process
+ *        is killed
+ *
+ * @param address address to listen on (tcp:<ip>:<port> or unix:<path>)
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if creating the server-socket failed
+ */
+bool
+AgentServer::startServer(const std::string &address,
+                         std::string &errorMessage)
+{
+    if(createServerSocket(address, errorMessage) == false) {
+        return false;
+    }
+
+    LOG_INFO("agent listening on " + address, GREEN_COLOR);
+
+    while(true)
+    {
+        const int clientSocket = accept(m_serverSocket, nullptr, nullptr);
+        if(clientSocket < 0)
+        {
+            if(errno == EINTR) {
+                continue;
+            }
+            errorMessage = "failed to accept new connection on " + address;
+            return false;
+        }
+
+        // each connection has its own reading thread, so their number must be limited
+        if(m_numberOfConnections.load() >= AGENT_MAX_CONNECTIONS)
+        {
+            LOG_WARNING("rejected agent-connection, because already "
+                        + std::to_string(AGENT_MAX_CONNECTIONS) + " connections are open");
+            close(clientSocket);
+            continue;
+        }
+        m_numberOfConnections++;
+
+        // disable nagle-algorithm, because the messages are small and latency is important
+        const int flag = 1;
+        setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+        std::thread connectionThread([this, clientSocket]()
+        {
+            handleConnection(clientSocket);
+            m_numberOfConnections--;
+        });
+        connectionThread.detach();
+    }
+
+    return true;
+}
+
+/**
+ * @brief create server-socket for tcp or unix-domain-socket
+ *
+ * @param address address to listen on (tcp:<ip>:<port> or unix:<path>)
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+AgentServer::createServerSocket(const std::string &address,
+                                std::string &errorMessage)
+{
+    std::string socketType = "";
+    std::string host = "";
+    std::string port = "";
+    if(parseAgentAddress(address, socketType, host, port) == false)
+    {
+        errorMessage = "invalid agent-address: " + address;
+        return false;
+    }
+
+    if(socketType == "unix")
+    {
+        struct sockaddr_un socketAddr;
+        memset(&socketAddr, 0, sizeof(socketAddr));
+        socketAddr.sun_family = AF_UNIX;
+        if(host.size() >= sizeof(socketAddr.sun_path))
+        {
+            errorMessage = "path of unix-socket is too long: " + host;
+            return false;
+        }
+        strncpy(socketAddr.sun_path, host.c_str(), sizeof(socketAddr.sun_path) - 1);
+        unlink(host.c_str());
+
+        m_serverSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(m_serverSocket < 0
+                || bind(m_serverSocket, (struct sockaddr*)&socketAddr, sizeof(socketAddr)) < 0)
+        {
+            errorMessage = "failed to bind unix-socket " + host;
+            return false;
+        }
+
+        // only the owner is allowed to connect to the socket
+        if(chmod(host.c_str(), S_IRUSR | S_IWUSR) != 0)
+        {
+            errorMessage = "failed to set permissions of unix-socket " + host;
+            return false;
+        }
+    }
+    else
+    {
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+
+        struct addrinfo* addrResult = nullptr;
+        if(getaddrinfo(host.c_str(), port.c_str(), &hints, &addrResult) != 0)
+        {
+            errorMessage = "failed to resolve address " + address;
+            return false;
+        }
+
+        // the agent runs every blossom, also commands, for the clients, so without a token it
+        // must not be reachable from other hosts
+        if(getAgentToken() == "")
+        {
+            if(isLoopbackAddress(addrResult->ai_addr) == false)
+            {
+                freeaddrinfo(addrResult);
+                errorMessage = "agent on non-loopback address " + address + " requires a "
+                               "token (SAKURA_AGENT_TOKEN or --agent-token-file)";
+                return false;
+            }
+
+            LOG_WARNING("agent on " + address + " runs without token, so every local user "
+                        "can run blossoms with the rights of the agent");
+        }
+
+        m_serverSocket = socket(addrResult->ai_family, SOCK_STREAM, 0);
+        const int flag = 1;
+        if(m_serverSocket >= 0) {
+            setsockopt(m_serverSocket, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+        }
+
+        const bool bindFailed = m_serverSocket < 0
+                                || bind(m_serverSocket,
+                                        addrResult->ai_addr,
+                                        addrResult->ai_addrlen) < 0;
+        freeaddrinfo(addrResult);
+        if(bindFailed)
+        {
+            errorMessage = "failed to bind tcp-socket to " + address;
+            return false;
+        }
+    }
+
+    if(listen(m_serverSocket, SOMAXCONN) < 0)
+    {
+        errorMessage = "failed to listen on " + address;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief read all incoming requests of a connection and give them to the thread-pool, so
+ *        multiple requests of the same connection can be processed at the same time
+ *
+ * @param socket socket of the connection
+ */
+void
+AgentServer::handleConnection(const int socket)
+{
+    std::shared_ptr<Connection> connection = std::make_shared<Connection>();
+    connection->socket = socket;
+
+    AgentMessageHeader header;
+    std::string payload;
+
+    // the first message of the connection must contain the shared token, so until it is
+    // verified, only small messages are accepted
+    if(recvAgentMessage(socket, header, payload, AGENT_MAX_AUTH_PAYLOAD_SIZE) == false) {
+        return;
+    }
+
+    AgentMessageHeader authHeader;
+    authHeader.type = AUTH_RESPONSE_TYPE;
+    authHeader.requestId = header.requestId;
+    if(header.type != AUTH_REQUEST_TYPE
+            || compareAgentTokens(payload, getAgentToken()) == false)
+    {
+        LOG_ERROR("rejected agent-connection with invalid token");
+        sendAgentMessage(socket, authHeader, "invalid token");
+        shutdown(socket, SHUT_RDWR);
+        return;
+    }
+    authHeader.success = 1;
+    if(sendAgentMessage(socket, authHeader, "") == false) {
+        return;
+    }
+
+    while(recvAgentMessage(socket, header, payload))
+    {
+        if(header.type != BLOSSOM_REQUEST_TYPE)
+        {
+            LOG_ERROR("received unknown message-type from controller");
+            break;
+        }
+
+        ThreadPool::getInstance()->addTask([connection, header, payload]()
+        {
+            processRequest(connection, header, payload);
+        });
+    }
+
+    // stop reading, but the socket is only closed after all responses were send
+    shutdown(socket, SHUT_RD);
+}
+
+/**
+ * @brief run the requested blossom and send the result back to the controller
+ *
+ * @param connection connection of the request
+ * @param header header of the request
+ * @param payload payload of the request
+ */
+void
+AgentServer::processRequest(std::shared_ptr<Connection> connection,
+                            const AgentMessageHeader &header,
+                            const std::string &payload)
+{
+    AgentMessageHeader responseHeader;
+    responseHeader.type = BLOSSOM_RESPONSE_TYPE;
+    responseHeader.requestId = header.requestId;
+
+    std::string errorMessage = "";
+    std::string response = "";
+    bool success = false;
+
+    // split payload into group, type and input-values
+    const size_t groupEnd = payload.find('\0');
+    const size_t typeEnd = payload.find('\0', groupEnd + 1);
+    if(groupEnd == std::string::npos
+            || typeEnd == std::string::npos)
+    {
+        errorMessage = "invalid blossom-request";
+    }
+    else
+    {
+        const std::string group = payload.substr(0, groupEnd);
+        const std::string type = payload.substr(groupEnd + 1, typeEnd - groupEnd - 1);
+        const std::string input = payload.substr(typeEnd + 1);
+
+        BlossomLeaf blossomLeaf;
+        blossomLeaf.blossomGroupType = group;
+        blossomLeaf.blossomType = type;
+        DataMap parentValues;
+        blossomLeaf.parentValues = &parentValues;
+
+        SakuraBlossom* blossom = SakuraRoot::m_root->getBlossom(group, type);
+        JsonItem inputItem;
+        if(blossom == nullptr)
+        {
+            errorMessage = "unknown blossom: " + group + " -> " + type;
+        }
+        else if(inputItem.parse(input, errorMessage))
+        {
+            DataItem* content = inputItem.getItemContent();
+            if(content != nullptr
+                    && content->isMap())
+            {
+                blossomLeaf.input = *content->toMap();
+                success = blossom->validateInput(blossomLeaf.input, errorMessage)
+                          && blossom->runBlossom(blossomLeaf, errorMessage);
+
+                // the controller expects the changes to be done, when the response arrives,
+                // so cached ini-files must be written back before
+                std::string flushError = "";
+                if(IniCache::getInstance()->flushAll(flushError) == false
+                        && success)
+                {
+                    errorMessage = flushError;
+                    success = false;
+                }
+            }
+            else
+            {
+                errorMessage = "input-values of the request are not a json-map";
+            }
+        }
+
+        if(success) {
+            response = blossomLeaf.output.toString();
+        }
+    }
+
+    if(success == false) {
+        response = errorMessage;
+    }
+    responseHeader.success = success;
+
+    std::lock_guard<std::mutex> guard(connection->writeLock);
+    sendAgentMessage(connection->socket, responseHeader, response);
+}
@@ -0,0 +1,60 @@
+/**
+ * @file        agent_server.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef AGENT_SERVER_H
+#define AGENT_SERVER_H
+
+#include <common.h>
+#include <atomic>
+#include <memory>
+
+struct AgentMessageHeader;
+
+class AgentServer
+{
+public:
+    AgentServer();
+    ~AgentServer();
+
+    bool startServer(const std::string &address, std::string &errorMessage);
+
+private:
+    struct Connection
+    {
+        int socket = -1;
+        std::mutex writeLock;
+
+        ~Connection();
+    };
+
+    int m_serverSocket = -1;
+    std::atomic<uint32_t> m_numberOfConnections {0};
+
+    bool createServerSocket(const std::string &address, std::string &errorMessage);
+    void handleConnection(const int socket);
+    static void processRequest(std::shared_ptr<Connection> connection,
+                               const AgentMessageHeader &header,
+                               const std::string &payload);
+};
+
+#endif // AGENT_SERVER_H
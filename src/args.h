@@ -18,12 +18,62 @@ registerArguments(Kitsunemimi::Args::ArgParser &argparser)
     argparser.registerPlain("dry-run",
                             "Try to parse and validate all file without executing the scripts");
 
-    // required input
+    argparser.registerString("agent-values",
+                             "Run as agent on a remote host. The initial values are read from the "
+                             "given json-file and the result is printed as json at the end. "
+                             "This is used by the subtree-blossom of the ssh-group.");
+
+    argparser.registerString("agent-listen",
+                             "Run as persistent agent, which listens on the given address "
+                             "(tcp:<ip>:<port> or unix:<path>) for blossom-requests of the "
+                             "agent-blossom. No input-path is required in this mode.");
+
+    argparser.registerString("agent-token-file",
+                             "File with the shared token, which is required by the persistent "
+                             "agent and sent by the agent-blossoms of the controller. The "
+                             "environment-variable SAKURA_AGENT_TOKEN has priority. Without "
+                             "token the agent only listens on unix-sockets or loopback.");
+
+    argparser.registerPlain("auto-parallel",
+                            "Run blossoms without output-values in background, where they only "
+                            "wait for previous blossoms, which use the same files, package-"
+                            "database or remote host. Commands wait for all previous blossoms.");
+
+    argparser.registerString("duration-history",
+                             "File, where the durations of the blossoms are stored, so parallel "
+                             "blossoms with the longest expected duration are started first in "
+                             "later runs. Default is ~/.sakura_tree/durations.");
+
+    argparser.registerPlain("no-duration-history",
+                            "Don't read and write the durations of the blossoms.");
+
+    argparser.registerPlain("fail-fast",
+                            "Cancel all other branches on the first error, where running "
+                            "commands are killed and queued blossoms are dropped. This is the "
+                            "default, if the environment-variable CI is set.");
+
+    argparser.registerPlain("no-fail-fast",
+                            "Let all other branches run to completion after an error, also if "
+                            "the environment-variable CI is set.");
+
+    argparser.registerString("resource-limit",
+                             "Maximum number of blossoms, which can use a resource at the same "
+                             "time, in the form <name>=<number>. The name can be a group "
+                             "(apt=1), a blossom of a group (path.copy=4) or per_host for all "
+                             "blossoms with the same remote address (per_host=8), which are "
+                             "also the defaults.");
+
+    argparser.registerInteger("max-threads",
+                              "Maximum number of threads and blossoms, which are running at the "
+                              "same time. Default is the number of cpu-cores, which are available "
+                              "for the process, also within a container.");
+
+    // required input, if not running as persistent agent
     argparser.registerString("input-path",
                              "Relative or absolut path to the initial sakura-file or to the "
                              "directory, which contains the sakura.root file, which should be "
                              "executed.",
-                             true,
+                             false,
                              true);
 
     return true;
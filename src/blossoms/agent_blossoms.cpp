@@ -0,0 +1,85 @@
+/**
+ * @file        agent_blossoms.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "agent_blossoms.h"
+
+#include <agent/agent_client.h>
+#include <caches/ini_cache.h>
+
+//==================================================================================================
+// AgentRunBlossom
+//==================================================================================================
+AgentRunBlossom::AgentRunBlossom()
+    : SakuraBlossom()
+{
+    validationMap.emplace("address", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("group", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("type", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("input", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("output", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
+}
+
+/**
+ * runTask
+ */
+bool
+AgentRunBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
+{
+    // write pending ini-changes back, before the files are accessed by the agent
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
+    const std::string address = blossomLeaf.input.getStringByKey("address");
+    const std::string group = blossomLeaf.input.getStringByKey("group");
+    const std::string type = blossomLeaf.input.getStringByKey("type");
+
+    DataMap input;
+    DataItem* inputItem = blossomLeaf.input.get("input");
+    if(inputItem != nullptr)
+    {
+        if(inputItem->isMap() == false)
+        {
+            errorMessage = "input for the agent has to be a map";
+            return false;
+        }
+        input = *inputItem->toMap();
+    }
+
+    std::shared_ptr<AgentClient> client = AgentClient::getClient(address, errorMessage);
+    if(client == nullptr) {
+        return false;
+    }
+
+    LOG_DEBUG("run blossom " + group + " -> " + type + " on agent " + address);
+    DataMap* output = new DataMap();
+    if(client->runBlossom(group, type, input, *output, errorMessage) == false)
+    {
+        delete output;
+        return false;
+    }
+
+    blossomLeaf.output.insert("output", output);
+
+    return true;
+}
@@ -27,6 +27,8 @@
 #include <libKitsunemimiPersistence/logger/logger.h>
 
 #include <sakura_root.h>
+#include <caches/ini_cache.h>
+#include <processing/process_reactor.h>
 
 /**
  * @brief get all with apt installed packages on the system
@@ -39,7 +41,7 @@ getInstalledPackages()
     const std::string command = "dpkg --list | grep ^ii  | awk ' {print \\$2} '";
     LOG_DEBUG("run command: " + command);
 
-    const ProcessResult processResult = runSyncProcess(command);
+    const ProcessResult processResult = runProcess(command);
     // TODO: check for error
     std::vector<std::string> result;
     Kitsunemimi::splitStringByDelimiter(result, processResult.processOutput, '\n');
@@ -138,7 +140,7 @@ getInstalledPackages(const std::vector<std::string> &packageList)
 // AptAbsentBlossom
 //==================================================================================================
 AptAbsentBlossom::AptAbsentBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("packages", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
 }
@@ -149,6 +151,11 @@ AptAbsentBlossom::AptAbsentBlossom()
 bool
 AptAbsentBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 {
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
     std::vector<std::string> packageNames;
 
     DataArray* names = blossomLeaf.input.get("packages")->toArray();
@@ -210,7 +217,7 @@ AptAbsentBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 // AptLatestBlossom
 //==================================================================================================
 AptLatestBlossom::AptLatestBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("packages", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
 }
@@ -221,6 +228,11 @@ AptLatestBlossom::AptLatestBlossom()
 bool
 AptLatestBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 {
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
     std::vector<std::string> packageNames;
 
     DataArray* names = blossomLeaf.input.get("packages")->toArray();
@@ -277,7 +289,7 @@ AptLatestBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 // AptPresentBlossom
 //==================================================================================================
 AptPresentBlossom::AptPresentBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("packages", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
 }
@@ -288,6 +300,11 @@ AptPresentBlossom::AptPresentBlossom()
 bool
 AptPresentBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 {
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
     std::vector<std::string> packageNames;
 
     DataArray* names = blossomLeaf.input.get("packages")->toArray();
@@ -351,7 +368,7 @@ AptPresentBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 // AptUdateBlossom
 //==================================================================================================
 AptUdateBlossom::AptUdateBlossom()
-    : Blossom() {}
+    : SakuraBlossom() {}
 
 /**
  * runTask
@@ -359,6 +376,11 @@ AptUdateBlossom::AptUdateBlossom()
 bool
 AptUdateBlossom::runTask(BlossomLeaf &, std::string &errorMessage)
 {
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
     const std::string command = "sudo apt-get update";
     return SakuraRoot::m_root->runCommand(command, errorMessage);
 }
@@ -367,7 +389,7 @@ AptUdateBlossom::runTask(BlossomLeaf &, std::string &errorMessage)
 // AptUpgradeBlossom
 //==================================================================================================
 AptUpgradeBlossom::AptUpgradeBlossom()
-    : Blossom() {}
+    : SakuraBlossom() {}
 
 
 /**
@@ -376,6 +398,11 @@ AptUpgradeBlossom::AptUpgradeBlossom()
 bool
 AptUpgradeBlossom::runTask(BlossomLeaf &, std::string &errorMessage)
 {
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
     const std::string command = "sudo apt-get -y upgrade";
     return SakuraRoot::m_root->runCommand(command, errorMessage);
 }
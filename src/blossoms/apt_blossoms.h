@@ -24,12 +24,13 @@
 #define APT_BLOSSOMS_H
 
 #include <common.h>
+#include <blossoms/sakura_blossom.h>
 
 //==================================================================================================
 // AptAbsentBlossom
 //==================================================================================================
 class AptAbsentBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 
 public:
@@ -43,7 +44,7 @@ protected:
 // AptLatestBlossom
 //==================================================================================================
 class AptLatestBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 
 public:
@@ -57,7 +58,7 @@ protected:
 // AptPresentBlossom
 //==================================================================================================
 class AptPresentBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 
 public:
@@ -71,7 +72,7 @@ protected:
 // AptUdateBlossom
 //==================================================================================================
 class AptUdateBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 
 public:
@@ -85,7 +86,7 @@ protected:
 // AptUpgradeBlossom
 //==================================================================================================
 class AptUpgradeBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 
 public:
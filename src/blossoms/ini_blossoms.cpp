@@ -21,21 +21,148 @@
  */
 
 #include "ini_blossoms.h"
-#include <libKitsunemimiPersistence/files/file_methods.h>
+#include <caches/ini_cache.h>
 #include <libKitsunemimiIni/ini_item.h>
-#include <libKitsunemimiPersistence/files/text_file.h>
 
 using Kitsunemimi::Ini::IniItem;
 
+/**
+ * @brief collect all entries, which should be processed by an ini-blossom. Entries can be
+ *        given as single group and entry, or as batch with the entries-input, which is
+ *        either a map of groups to a map of entries and values (or a list of entry-names),
+ *        or a list of maps with group, entry and value.
+ *
+ * @param result reference for the resulting list of entries
+ * @param blossomLeaf blossom-leaf with the input-values
+ * @param withValue true, if a value is required for each entry
+ * @param withoutEntry true, if entire groups without an entry are allowed
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if input is invalid, else true
+ */
+bool
+collectIniEntries(std::vector<IniEntryRequest> &result,
+                  BlossomLeaf &blossomLeaf,
+                  const bool withValue,
+                  const bool withoutEntry,
+                  std::string &errorMessage)
+{
+    // single entry
+    DataItem* entriesItem = blossomLeaf.input.get("entries");
+    if(entriesItem == nullptr)
+    {
+        IniEntryRequest request;
+        request.group = blossomLeaf.input.getStringByKey("group");
+        request.entry = blossomLeaf.input.getStringByKey("entry");
+        request.value = blossomLeaf.input.get("value");
+        result.push_back(request);
+    }
+    // map of groups
+    else if(entriesItem->isMap())
+    {
+        DataMap* groups = entriesItem->toMap();
+        const std::vector<std::string> groupNames = groups->getKeys();
+
+        for(const std::string &groupName : groupNames)
+        {
+            DataItem* groupItem = groups->get(groupName);
+
+            IniEntryRequest request;
+            request.group = groupName;
+
+            if(groupItem->isMap())
+            {
+                DataMap* entries = groupItem->toMap();
+                const std::vector<std::string> entryNames = entries->getKeys();
+                for(const std::string &entryName : entryNames)
+                {
+                    request.entry = entryName;
+                    request.value = entries->get(entryName);
+                    result.push_back(request);
+                }
+            }
+            else if(groupItem->isArray())
+            {
+                DataArray* entries = groupItem->toArray();
+                for(uint64_t i = 0; i < entries->size(); i++)
+                {
+                    request.entry = entries->get(i)->toString();
+                    result.push_back(request);
+                }
+            }
+            else
+            {
+                // a value instead of entries means the entire group
+                result.push_back(request);
+            }
+        }
+    }
+    // list of group-entry-value-triples
+    else if(entriesItem->isArray())
+    {
+        DataArray* entries = entriesItem->toArray();
+        for(uint64_t i = 0; i < entries->size(); i++)
+        {
+            DataItem* entryItem = entries->get(i);
+            if(entryItem->isMap() == false)
+            {
+                errorMessage = "each item in the list of entries must be a map with "
+                               "group, entry and value";
+                return false;
+            }
+
+            DataMap* entryMap = entryItem->toMap();
+            IniEntryRequest request;
+            request.group = entryMap->getStringByKey("group");
+            request.entry = entryMap->getStringByKey("entry");
+            request.value = entryMap->get("value");
+            result.push_back(request);
+        }
+    }
+    else
+    {
+        errorMessage = "entries must be a map or a list";
+        return false;
+    }
+
+    // check collected entries
+    for(const IniEntryRequest &request : result)
+    {
+        if(request.group == "")
+        {
+            errorMessage = "group is missing for an ini-entry";
+            return false;
+        }
+
+        if(withoutEntry == false
+                && request.entry == "")
+        {
+            errorMessage = "entry is missing in group " + request.group;
+            return false;
+        }
+
+        if(withValue
+                && request.value == nullptr)
+        {
+            errorMessage = "value is missing for entry " + request.entry
+                           + " in group " + request.group;
+            return false;
+        }
+    }
+
+    return true;
+}
+
 //==================================================================================================
 // IniDeleteEntryBlossom
 //==================================================================================================
 IniDeleteEntryBlossom::IniDeleteEntryBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("file_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
-    validationMap.emplace("group", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("group", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
     validationMap.emplace("entry", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("entries", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
 }
 
 /**
@@ -45,36 +172,31 @@ bool
 IniDeleteEntryBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 {
     const std::string filePath = blossomLeaf.input.getStringByKey("file_path");
-    const std::string group = blossomLeaf.input.getStringByKey("group");
-    const std::string entry = blossomLeaf.input.getStringByKey("entry");
 
-    // precheck
-    if(bfs::exists(filePath) == false)
-    {
-        errorMessage = "file-path " + filePath + " doesn't exist";
+    std::vector<IniEntryRequest> requests;
+    if(collectIniEntries(requests, blossomLeaf, false, true, errorMessage) == false) {
         return false;
     }
 
-    // read file-content
-    std::string fileContent = "";
-    const bool result = Kitsunemimi::Persistence::readFile(fileContent, filePath, errorMessage);
-    if(result == false) {
+    // get parsed file-content from cache
+    IniItem* iniItem = IniCache::getInstance()->lockItem(filePath, errorMessage);
+    if(iniItem == nullptr) {
         return false;
     }
 
-    // parse file-content
-    IniItem iniItem;
-    const bool parseSuccess = iniItem.parse(fileContent, errorMessage);
-    if(parseSuccess == false) {
-        return false;
+    // delete entries or entire groups
+    bool modified = false;
+    for(const IniEntryRequest &request : requests)
+    {
+        if(request.entry == "") {
+            modified = iniItem->removeGroup(request.group) || modified;
+        } else {
+            modified = iniItem->removeEntry(request.group, request.entry) || modified;
+        }
     }
 
-    // delete entry or entire group
-    if(entry == "") {
-        iniItem.removeGroup(group);
-    } else {
-        iniItem.removeEntry(group, entry);
-    }
+    // changes are written back to the file by the cache
+    IniCache::getInstance()->unlockItem(filePath, modified);
 
     return true;
 }
@@ -83,12 +205,14 @@ IniDeleteEntryBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessa
 // IniReadEntryBlossom
 //==================================================================================================
 IniReadEntryBlossom::IniReadEntryBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("file_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
-    validationMap.emplace("group", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
-    validationMap.emplace("entry", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
-    validationMap.emplace("value", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, true));
+    validationMap.emplace("group", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("entry", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("entries", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("value", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
+    validationMap.emplace("values", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
 }
 
 /**
@@ -98,32 +222,58 @@ bool
 IniReadEntryBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 {
     const std::string filePath = blossomLeaf.input.getStringByKey("file_path");
-    const std::string group = blossomLeaf.input.getStringByKey("group");
-    const std::string entry = blossomLeaf.input.getStringByKey("entry");
 
-    // precheck
-    if(bfs::exists(filePath) == false)
-    {
-        errorMessage = "file-path " + filePath + " doesn't exist";
+    std::vector<IniEntryRequest> requests;
+    if(collectIniEntries(requests, blossomLeaf, false, false, errorMessage) == false) {
         return false;
     }
 
-    // read file-content
-    std::string fileContent = "";
-    const bool result = Kitsunemimi::Persistence::readFile(fileContent, filePath, errorMessage);
-    if(result == false) {
+    // get parsed file-content from cache
+    IniItem* iniItem = IniCache::getInstance()->lockItem(filePath, errorMessage);
+    if(iniItem == nullptr) {
         return false;
     }
 
-    // parse file-content
-    IniItem iniItem;
-    const bool parseSuccess = iniItem.parse(fileContent, errorMessage);
-    if(parseSuccess == false) {
+    // collect all requested values as map of groups
+    DataMap* values = new DataMap();
+    bool result = true;
+    for(const IniEntryRequest &request : requests)
+    {
+        DataItem* value = iniItem->get(request.group, request.entry);
+        if(value == nullptr)
+        {
+            errorMessage = "entry " + request.entry + " in group " + request.group
+                           + " doesn't exist in file " + filePath;
+            result = false;
+            break;
+        }
+
+        DataItem* groupItem = values->get(request.group);
+        if(groupItem == nullptr)
+        {
+            groupItem = new DataMap();
+            values->insert(request.group, groupItem);
+        }
+        groupItem->toMap()->insert(request.entry, value->copy(), true);
+    }
+
+    IniCache::getInstance()->unlockItem(filePath, false);
+
+    if(result == false)
+    {
+        delete values;
         return false;
     }
 
-    // write read value into output-values
-    blossomLeaf.output.insert("value", iniItem.get(group, entry)->copy());
+    // a single requested entry is additionally returned as plain value
+    if(requests.size() == 1)
+    {
+        const IniEntryRequest &request = requests.at(0);
+        DataItem* value = values->get(request.group)->get(request.entry);
+        blossomLeaf.output.insert("value", value->copy());
+    }
+
+    blossomLeaf.output.insert("values", values);
 
     return true;
 }
@@ -132,12 +282,13 @@ IniReadEntryBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage
 // IniSetEntryBlossom
 //==================================================================================================
 IniSetEntryBlossom::IniSetEntryBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("file_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
-    validationMap.emplace("group", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
-    validationMap.emplace("entry", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
-    validationMap.emplace("value", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("group", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("entry", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("value", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("entries", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
 }
 
 /**
@@ -147,45 +298,34 @@ bool
 IniSetEntryBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 {
     const std::string filePath = blossomLeaf.input.getStringByKey("file_path");
-    const std::string group = blossomLeaf.input.getStringByKey("group");
-    const std::string entry = blossomLeaf.input.getStringByKey("entry");
-    const std::string value = blossomLeaf.input.getStringByKey("value");
 
-    // precheck
-    if(bfs::exists(filePath) == false)
-    {
-        errorMessage = "file-path " + filePath + " doesn't exist";
+    std::vector<IniEntryRequest> requests;
+    if(collectIniEntries(requests, blossomLeaf, true, false, errorMessage) == false) {
         return false;
     }
 
-    // read file-content
-    std::string fileContent = "";
-    const bool result = Kitsunemimi::Persistence::readFile(fileContent, filePath, errorMessage);
-    if(result == false) {
+    // get parsed file-content from cache
+    IniItem* iniItem = IniCache::getInstance()->lockItem(filePath, errorMessage);
+    if(iniItem == nullptr) {
         return false;
     }
 
-    // parse file-content
-    IniItem iniItem;
-    const bool parseResult = iniItem.parse(fileContent, errorMessage);
-    if(parseResult == false) {
-        return false;
+    // set new values, only if they are different from the old ones
+    bool modified = false;
+    for(const IniEntryRequest &request : requests)
+    {
+        const std::string value = request.value->toString();
+        DataItem* oldValue = iniItem->get(request.group, request.entry);
+        if(oldValue == nullptr
+                || oldValue->toString() != value)
+        {
+            iniItem->set(request.group, request.entry, value, true);
+            modified = true;
+        }
     }
 
-    // set new value
-    iniItem.set(group, entry, value, true);
-
-    // write updated string back to file
-    const std::string newFileContent = iniItem.toString();
-    errorMessage.clear();
-    const bool writeResult = Kitsunemimi::Persistence::writeFile(filePath,
-                                                                 newFileContent,
-                                                                 errorMessage,
-                                                                 true);
-    if(writeResult == false) {
-        return false;
-    }
+    // changes are written back to the file by the cache
+    IniCache::getInstance()->unlockItem(filePath, modified);
 
     return true;
 }
-
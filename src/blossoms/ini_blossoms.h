@@ -24,12 +24,26 @@
 #define INI_BLOSSOMS_H
 
 #include <common.h>
+#include <blossoms/sakura_blossom.h>
+
+struct IniEntryRequest
+{
+    std::string group = "";
+    std::string entry = "";
+    DataItem* value = nullptr;
+};
+
+bool collectIniEntries(std::vector<IniEntryRequest> &result,
+                       BlossomLeaf &blossomLeaf,
+                       const bool withValue,
+                       const bool withoutEntry,
+                       std::string &errorMessage);
 
 //==================================================================================================
 // IniDeleteEntryBlossom
 //==================================================================================================
 class IniDeleteEntryBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     IniDeleteEntryBlossom();
@@ -42,7 +56,7 @@ protected:
 // IniReadEntryBlossom
 //==================================================================================================
 class IniReadEntryBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     IniReadEntryBlossom();
@@ -55,7 +69,7 @@ protected:
 // IniSetEntryBlossom
 //==================================================================================================
 class IniSetEntryBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     IniSetEntryBlossom();
@@ -22,6 +22,9 @@
 
 #include "path_blossoms.h"
 
+#include <caches/ini_cache.h>
+#include <processing/process_reactor.h>
+
 #include <sakura_root.h>
 
 #include <libKitsunemimiPersistence/files/file_methods.h>
@@ -41,7 +44,7 @@ using Kitsunemimi::splitStringByDelimiter;
 // PathChmodBlossom
 //==================================================================================================
 PathChmodBlossom::PathChmodBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("permission", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
@@ -56,6 +59,11 @@ PathChmodBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
     const std::string path = blossomLeaf.input.getStringByKey("path");
     const std::string permission = blossomLeaf.input.getStringByKey("permission");
 
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
     // precheck
     if(bfs::exists(path) == false)
     {
@@ -79,7 +87,7 @@ PathChmodBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 // PathChownBlossom
 //==================================================================================================
 PathChownBlossom::PathChownBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("owner", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
@@ -94,6 +102,11 @@ PathChownBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
     const std::string path = blossomLeaf.input.getStringByKey("path");
     const std::string owner = blossomLeaf.input.getStringByKey("owner");
 
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
     // precheck
     if(bfs::exists(path) == false)
     {
@@ -117,7 +130,7 @@ PathChownBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 // PathDeleteBlossom
 //==================================================================================================
 PathCopyBlossom::PathCopyBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("source_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("dest_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
@@ -138,6 +151,11 @@ PathCopyBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
     const std::string owner = blossomLeaf.input.getStringByKey("owner");
     bool localStorage = false;
 
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
     // prepare source-path
     if(sourcePath.at(0) != '/')
     {
@@ -199,7 +217,7 @@ PathCopyBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
         command += destinationPath;
 
         LOG_DEBUG("run command: " + command);
-        ProcessResult processResult = runSyncProcess(command);
+        ProcessResult processResult = runProcess(command);
         if(processResult.success == false)
         {
             errorMessage = processResult.processOutput;
@@ -236,7 +254,7 @@ PathCopyBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 // PathDeleteBlossom
 //==================================================================================================
 PathDeleteBlossom::PathDeleteBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
 }
@@ -249,6 +267,11 @@ PathDeleteBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 {
     const std::string path = blossomLeaf.input.getStringByKey("path");
 
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
     // precheck
     if(bfs::exists(path) == false)
     {
@@ -279,7 +302,7 @@ PathDeleteBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 // PathRenameBlossom
 //==================================================================================================
 PathRenameBlossom::PathRenameBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("new_name", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
@@ -294,6 +317,11 @@ PathRenameBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
     const std::string path = blossomLeaf.input.getStringByKey("path");
     std::string newFileName = blossomLeaf.input.getStringByKey("new_name");
 
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
     std::vector<std::string> stringParts;
     splitStringByDelimiter(stringParts, path, '/');
     stringParts[stringParts.size()-1] = newFileName;
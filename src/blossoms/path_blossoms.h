@@ -24,12 +24,13 @@
 #define PATH_BLOSSOMS_H
 
 #include <common.h>
+#include <blossoms/sakura_blossom.h>
 
 //==================================================================================================
 // PathChmodBlossom
 //==================================================================================================
 class PathChmodBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     PathChmodBlossom();
@@ -42,7 +43,7 @@ protected:
 // PathChownBlossom
 //==================================================================================================
 class PathChownBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     PathChownBlossom();
@@ -55,7 +56,7 @@ protected:
 // PathCopyBlossom
 //==================================================================================================
 class PathCopyBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     PathCopyBlossom();
@@ -68,7 +69,7 @@ protected:
 // PathDeleteBlossom
 //==================================================================================================
 class PathDeleteBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     PathDeleteBlossom();
@@ -81,7 +82,7 @@ protected:
 // PathRenameBlossom
 //==================================================================================================
 class PathRenameBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     PathRenameBlossom();
@@ -0,0 +1,166 @@
+/**
+ * @file        sakura_blossom.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "sakura_blossom.h"
+
+/**
+ * @brief constructor
+ */
+SakuraBlossom::SakuraBlossom()
+    : Blossom() {}
+
+/**
+ * @brief run the task of the blossom
+ *
+ * @param blossomLeaf blossom-leaf with the input-values
+ * @param errorMessage reference for error-message
+ *
+ * @return result of the task
+ */
+bool
+SakuraBlossom::runBlossom(BlossomLeaf &blossomLeaf,
+                          std::string &errorMessage)
+{
+    return runTask(blossomLeaf, errorMessage);
+}
+
+/**
+ * @brief start the task of the blossom without waiting for its end. The callback is called
+ *        exactly once by the process-reactor, when the task is finished, but only if the start
+ *        was successful. It must return quickly, because it blocks the supervision of all
+ *        other processes. The blossom-leaf must be valid until the callback was called.
+ *
+ * @param blossomLeaf blossom-leaf with the input-values
+ * @param callback function, which is called with the result of the task
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if the task couldn't be started, else true
+ */
+bool
+SakuraBlossom::startBlossom(BlossomLeaf &blossomLeaf,
+                            const BlossomCallback &callback,
+                            std::string &errorMessage)
+{
+    return startTask(blossomLeaf, callback, errorMessage);
+}
+
+/**
+ * @brief default for blossoms, which can only be run synchronously
+ *
+ * @param blossomLeaf blossom-leaf with the input-values
+ * @param callback function, which is called with the result of the task
+ * @param errorMessage reference for error-message
+ *
+ * @return always false
+ */
+bool
+SakuraBlossom::startTask(BlossomLeaf &blossomLeaf,
+                         const BlossomCallback &callback,
+                         std::string &errorMessage)
+{
+    errorMessage = "blossom can not be started asynchronously";
+    return false;
+}
+
+/**
+ * @brief check input-values against the validation-map of the blossom with the same rules,
+ *        which are used by libKitsunemimiSakuraLang for blossoms within a tree
+ *
+ * @param input input-values to check
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if input is valid, else false
+ */
+bool
+SakuraBlossom::validateInput(const DataMap &input,
+                             std::string &errorMessage) const
+{
+    // check for unknown input-values
+    if(allowUnmatched == false)
+    {
+        std::map<std::string, DataItem*>::const_iterator inputIt;
+        for(inputIt = input.m_map.begin();
+            inputIt != input.m_map.end();
+            inputIt++)
+        {
+            std::map<std::string, BlossomValidDef>::const_iterator defIt;
+            defIt = validationMap.find(inputIt->first);
+            if(defIt == validationMap.end()
+                    || defIt->second.type != IO_ValueType::INPUT_TYPE)
+            {
+                errorMessage = "variable \"" + inputIt->first + "\" is not allowed as input";
+                return false;
+            }
+        }
+    }
+
+    // check for missing required input-values
+    std::map<std::string, BlossomValidDef>::const_iterator defIt;
+    for(defIt = validationMap.begin();
+        defIt != validationMap.end();
+        defIt++)
+    {
+        if(defIt->second.type == IO_ValueType::INPUT_TYPE
+                && defIt->second.isRequired
+                && input.m_map.find(defIt->first) == input.m_map.end())
+        {
+            errorMessage = "variable \"" + defIt->first + "\" is required, but not set";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief get the definitions of the input- and output-values of the blossom
+ *
+ * @return validation-map of the blossom
+ */
+const std::map<std::string, BlossomValidDef>&
+SakuraBlossom::getValidationMap() const
+{
+    return validationMap;
+}
+
+/**
+ * @brief check if the blossom accepts input-values, which are not in the validation-map
+ *
+ * @return true, if unknown input-values are allowed, else false
+ */
+bool
+SakuraBlossom::getAllowUnmatched() const
+{
+    return allowUnmatched;
+}
+
+/**
+ * @brief check if the blossom can be started asynchronously with startBlossom
+ *
+ * @return true, if an asynchronous start is supported, else false
+ */
+bool
+SakuraBlossom::getAllowAsyncStart() const
+{
+    return allowAsyncStart;
+}
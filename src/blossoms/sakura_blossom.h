@@ -0,0 +1,64 @@
+/**
+ * @file        sakura_blossom.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef SAKURA_BLOSSOM_H
+#define SAKURA_BLOSSOM_H
+
+#include <common.h>
+
+#include <functional>
+
+typedef std::function<void(const bool success, const std::string &errorMessage)> BlossomCallback;
+
+/**
+ * @brief Base-class of all blossoms of this tool. It provides a public entry-point to validate
+ *        and run a blossom outside of the processing of libKitsunemimiSakuraLang, for example
+ *        for requests, which are coming from another host, or for blossoms, which are running
+ *        in background. Blossoms, which consist of only one process, can also be started
+ *        asynchronously, so no thread has to wait for the end of their process.
+ */
+class SakuraBlossom
+        : public Kitsunemimi::Sakura::Blossom
+{
+public:
+    SakuraBlossom();
+
+    bool runBlossom(BlossomLeaf &blossomLeaf, std::string &errorMessage);
+    bool startBlossom(BlossomLeaf &blossomLeaf,
+                      const BlossomCallback &callback,
+                      std::string &errorMessage);
+    bool validateInput(const DataMap &input, std::string &errorMessage) const;
+
+    const std::map<std::string, BlossomValidDef>& getValidationMap() const;
+    bool getAllowUnmatched() const;
+    bool getAllowAsyncStart() const;
+
+protected:
+    bool allowAsyncStart = false;
+
+    virtual bool startTask(BlossomLeaf &blossomLeaf,
+                           const BlossomCallback &callback,
+                           std::string &errorMessage);
+};
+
+#endif // SAKURA_BLOSSOM_H
@@ -22,6 +22,9 @@
 
 #include "special_blossoms.h"
 
+#include <caches/ini_cache.h>
+#include <processing/process_reactor.h>
+
 #include <libKitsunemimiCommon/common_methods/string_methods.h>
 #include <libKitsunemimiCommon/process_execution.h>
 #include <libKitsunemimiCommon/common_items/table_item.h>
@@ -30,7 +33,7 @@
 // PrintBlossom
 //==================================================================================================
 AssertBlossom::AssertBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     allowUnmatched = true;
 }
@@ -46,7 +49,14 @@ AssertBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
         it != blossomLeaf.input.m_map.end();
         it++)
     {
-        const std::string isValue = blossomLeaf.parentValues->get(it->first)->toString();
+        DataItem* item = blossomLeaf.parentValues->get(it->first);
+        if(item == nullptr)
+        {
+            errorMessage = "the variable \"" + it->first + "\" doesn't exist";
+            return false;
+        }
+
+        const std::string isValue = item->toString();
         const std::string shouldValue = it->second->toString();
 
         if(isValue != shouldValue)
@@ -69,7 +79,7 @@ AssertBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 // PrintBlossom
 //==================================================================================================
 CmdBlossom::CmdBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("command", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("ignore_errors", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
@@ -87,6 +97,11 @@ CmdBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
     bool ignoreResult = false;
     bool trimOutput = false;
 
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
     // check if ignore_errors was set
     Kitsunemimi::DataItem* ignoreResultItem = blossomLeaf.input.get("ignore_errors");
     if(ignoreResultItem != nullptr) {
@@ -101,7 +116,7 @@ CmdBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 
     // run command
     LOG_DEBUG("run command: " + command);
-    Kitsunemimi::ProcessResult processResult = Kitsunemimi::runSyncProcess(command);
+    Kitsunemimi::ProcessResult processResult = runProcess(command);
 
     // check result
     LOG_DEBUG("command-output: \n" + processResult.processOutput);
@@ -126,7 +141,7 @@ CmdBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 // PrintBlossom
 //==================================================================================================
 ExitBlossom::ExitBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("status", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
 }
@@ -146,11 +161,21 @@ ExitBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 // PrintBlossom
 //==================================================================================================
 ItemUpdateBlossom::ItemUpdateBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     allowUnmatched = true;
 }
 
+/**
+ * @brief destructor, which deletes all values, which were replaced while the process was running
+ */
+ItemUpdateBlossom::~ItemUpdateBlossom()
+{
+    for(DataItem* value : m_replacedValues) {
+        delete value;
+    }
+}
+
 /**
  * runTask
  */
@@ -164,13 +189,17 @@ ItemUpdateBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
     {
         std::map<std::string, DataItem*>::iterator originalIt;
         originalIt = blossomLeaf.parentValues->m_map.find(it->first);
-
-        if(originalIt != blossomLeaf.parentValues->m_map.end())
-        {
-            blossomLeaf.parentValues->insert(it->first,
-                                             it->second->copy(),
-                                             true);
+        if(originalIt == blossomLeaf.parentValues->m_map.end()) {
+            continue;
         }
+
+        // the old value is not deleted, because parallel branches could still read it, while
+        // libKitsunemimiSakuraLang accesses the values without any lock. So replaced values
+        // are only deleted together with the blossom at the end of the process.
+        DataItem* newValue = it->second->copy();
+        std::lock_guard<std::mutex> guard(m_updateLock);
+        m_replacedValues.push_back(originalIt->second);
+        originalIt->second = newValue;
     }
 
     return true;
@@ -180,7 +209,7 @@ ItemUpdateBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 // PrintBlossom
 //==================================================================================================
 PrintBlossom::PrintBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     allowUnmatched = true;
 }
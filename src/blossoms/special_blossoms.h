@@ -24,6 +24,7 @@
 #define SPECIAL_BLOSSOMS_H
 
 #include <common.h>
+#include <blossoms/sakura_blossom.h>
 
 #include <libKitsunemimiSakuraLang/blossom.h>
 
@@ -31,7 +32,7 @@
 // AssertBlossom
 //==================================================================================================
 class AssertBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 
 public:
@@ -45,7 +46,7 @@ protected:
 // CmdBlossom
 //==================================================================================================
 class CmdBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 
 public:
@@ -59,7 +60,7 @@ protected:
 // ExitBlossom
 //==================================================================================================
 class ExitBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     ExitBlossom();
@@ -72,21 +73,26 @@ protected:
 // ItemUpdateBlossom
 //==================================================================================================
 class ItemUpdateBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 
 public:
     ItemUpdateBlossom();
+    ~ItemUpdateBlossom();
 
 protected:
     bool runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage);
+
+private:
+    std::mutex m_updateLock;
+    std::vector<DataItem*> m_replacedValues;
 };
 
 //==================================================================================================
 // PrintBlossom
 //==================================================================================================
 class PrintBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 
 public:
@@ -22,14 +22,66 @@
 
 #include "ssh_blossoms.h"
 
+#include <caches/ini_cache.h>
+#include <helper/file_helper.h>
+#include <processing/duration_history.h>
+#include <processing/fail_fast.h>
+#include <processing/process_reactor.h>
+#include <processing/resource_limits.h>
+
+#include <sakura_root.h>
+
+#include <libKitsunemimiSakuraLang/sakura_lang_interface.h>
+
 #include <libKitsunemimiCommon/common_methods/string_methods.h>
 #include <libKitsunemimiCommon/process_execution.h>
 
+#include <libKitsunemimiPersistence/files/text_file.h>
+#include <libKitsunemimiPersistence/files/file_methods.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <set>
+
+/**
+ * @brief create the ssh-call for a remote host without the command
+ *
+ * @param blossomLeaf actual blossom-leaf with the connection-information
+ *
+ * @return ssh-call
+ */
+const std::string
+createSshCall(BlossomLeaf &blossomLeaf)
+{
+    const std::string user = blossomLeaf.input.getStringByKey("user");
+    const std::string address = blossomLeaf.input.getStringByKey("address");
+    const std::string port = blossomLeaf.input.getStringByKey("port");
+    const std::string sshKey = blossomLeaf.input.getStringByKey("ssh_key");
+
+    std::string programm = "ssh";
+    if(port != "") {
+        programm += " -p " + port;
+    }
+    if(sshKey != "") {
+        programm += " -i " + sshKey;
+    }
+
+    programm += " ";
+    programm += user;
+    programm += "@";
+    programm += address;
+    programm += " -T ";
+
+    return programm;
+}
+
 //==================================================================================================
 // SshCmdBlossom
 //==================================================================================================
 SshCmdBlossom::SshCmdBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("user", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("address", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
@@ -37,13 +89,19 @@ SshCmdBlossom::SshCmdBlossom()
     validationMap.emplace("port", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
     validationMap.emplace("ssh_key", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
     validationMap.emplace("output", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
+
+    allowAsyncStart = true;
 }
 
 /**
- * runTask
+ * @brief create the complete ssh-call of the cmd-blossom
+ *
+ * @param blossomLeaf actual blossom-leaf with the connection-information and the command
+ *
+ * @return ssh-call, which can be given to the process-reactor
  */
-bool
-SshCmdBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
+const std::string
+createSshCmdCall(BlossomLeaf &blossomLeaf)
 {
     const std::string user = blossomLeaf.input.getStringByKey("user");
     const std::string address = blossomLeaf.input.getStringByKey("address");
@@ -70,7 +128,24 @@ SshCmdBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 
     LOG_DEBUG("run command: " + programm);
     Kitsunemimi::replaceSubstring(programm, "\"", "\\\"");
-    Kitsunemimi::ProcessResult processResult = Kitsunemimi::runSyncProcess(programm);
+
+    return programm;
+}
+
+/**
+ * @brief check the result of the ssh-call of the cmd-blossom and write its output
+ *
+ * @param blossomLeaf actual blossom-leaf for the output
+ * @param processResult result of the ssh-call
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if the command was successful, else false
+ */
+bool
+finishSshCmd(BlossomLeaf &blossomLeaf,
+             const ProcessResult &processResult,
+             std::string &errorMessage)
+{
     if(processResult.success == false)
     {
         errorMessage = processResult.processOutput;
@@ -82,11 +157,52 @@ SshCmdBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
     return true;
 }
 
+/**
+ * runTask
+ */
+bool
+SshCmdBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
+{
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
+    const ProcessResult processResult = runProcess(createSshCmdCall(blossomLeaf));
+
+    return finishSshCmd(blossomLeaf, processResult, errorMessage);
+}
+
+/**
+ * @brief start the ssh-call in background, so no thread waits for the remote command
+ */
+bool
+SshCmdBlossom::startTask(BlossomLeaf &blossomLeaf,
+                         const BlossomCallback &callback,
+                         std::string &errorMessage)
+{
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
+    BlossomLeaf* leaf = &blossomLeaf;
+    ProcessReactor* reactor = ProcessReactor::getInstance();
+    return reactor->startProcess(createSshCmdCall(blossomLeaf),
+                                 [leaf, callback](const ProcessResult &processResult)
+    {
+        std::string processError = "";
+        const bool result = finishSshCmd(*leaf, processResult, processError);
+        callback(result, processError);
+    },
+    errorMessage);
+}
+
 //==================================================================================================
 // SshCmdCreateFileBlossom
 //==================================================================================================
 SshCmdCreateFileBlossom::SshCmdCreateFileBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("user", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("address", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
@@ -130,7 +246,7 @@ SshCmdCreateFileBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMes
 
     LOG_DEBUG("run command: " + programm);
     Kitsunemimi::replaceSubstring(programm, "\"", "\\\"");
-    Kitsunemimi::ProcessResult processResult = Kitsunemimi::runSyncProcess(programm);
+    Kitsunemimi::ProcessResult processResult = runProcess(programm);
 
     if(processResult.success == false)
     {
@@ -164,7 +280,223 @@ SshCmdCreateFileBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMes
 
     LOG_DEBUG("run command: " + programm);
     Kitsunemimi::replaceSubstring(programm, "\"", "\\\"");
-    processResult = Kitsunemimi::runSyncProcess(programm);
+    processResult = runProcess(programm);
+
+    if(processResult.success == false)
+    {
+        errorMessage = processResult.processOutput;
+        return false;
+    }
+
+    return true;
+}
+
+//==================================================================================================
+// SshFactsBlossom
+//==================================================================================================
+SshFactsBlossom::SshFactsBlossom()
+    : SakuraBlossom()
+{
+    validationMap.emplace("user", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("address", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("port", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("ssh_key", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("refresh", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("facts", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, true));
+}
+
+// script, which is executed on the remote host to collect all facts at once and print them
+// as one key-value-pair per line, so no value has to be escaped by the script
+const std::string factsScript = R"SCRIPT(
+echo SAKURA_FACTS
+if [ -f /etc/os-release ]; then
+    . /etc/os-release
+fi
+printf 'os.id=%s\n' "$ID"
+printf 'os.version_id=%s\n' "$VERSION_ID"
+printf 'os.name=%s\n' "$PRETTY_NAME"
+printf 'hostname=%s\n' "$(hostname)"
+printf 'kernel=%s\n' "$(uname -r)"
+awk '/^MemTotal:/ {print "memory.total_kb=" $2}
+     /^MemAvailable:/ {print "memory.available_kb=" $2}' /proc/meminfo
+df -P -k 2>/dev/null | awk 'NR > 1 {print "disk=" $2 "\t" $4 "\t" $6}'
+ip -o addr show 2>/dev/null | awk '{split($4, a, "/"); print "interface=" $2 "\t" a[1]}'
+dpkg-query -W -f='${db:Status-Abbrev} ${Package}\n' 2>/dev/null \
+    | awk '$1 == "ii" {print "package=" $2}'
+)SCRIPT";
+
+static std::mutex factsLock;
+static std::map<std::string, std::unique_ptr<DataMap>> factsCache;
+
+/**
+ * @brief convert the output of the facts-script into a map with the same structure for each
+ *        host, where missing facts have empty or zero values
+ *
+ * @param output output of the facts-script
+ * @param facts reference for the resulting facts
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if the output doesn't contain the facts, else true
+ */
+bool
+parseFacts(const std::string &output,
+           DataMap &facts,
+           std::string &errorMessage)
+{
+    // skip possible warnings of ssh before the facts
+    const std::string startMarker = "SAKURA_FACTS\n";
+    const size_t factsStart = output.find(startMarker);
+    if(factsStart == std::string::npos)
+    {
+        errorMessage = "invalid output of fact-collection:\n" + output;
+        return false;
+    }
+
+    std::map<std::string, std::string> values = { {"os.id", ""},
+                                                   {"os.version_id", ""},
+                                                   {"os.name", ""},
+                                                   {"hostname", ""},
+                                                   {"kernel", ""},
+                                                   {"memory.total_kb", "0"},
+                                                   {"memory.available_kb", "0"} };
+    DataMap* disks = new DataMap();
+    DataMap* interfaces = new DataMap();
+    DataArray* packages = new DataArray();
+
+    std::vector<std::string> lines;
+    const std::string factsOutput = output.substr(factsStart + startMarker.size());
+    Kitsunemimi::splitStringByDelimiter(lines, factsOutput, '\n');
+    for(const std::string &line : lines)
+    {
+        const size_t separatorPos = line.find('=');
+        if(separatorPos == std::string::npos) {
+            continue;
+        }
+
+        const std::string key = line.substr(0, separatorPos);
+        const std::string value = line.substr(separatorPos + 1);
+
+        if(key == "package")
+        {
+            packages->append(new DataValue(value));
+        }
+        else if(key == "interface")
+        {
+            const size_t tabPos = value.find('\t');
+            if(tabPos == std::string::npos) {
+                continue;
+            }
+
+            const std::string name = value.substr(0, tabPos);
+            DataItem* addresses = interfaces->get(name);
+            if(addresses == nullptr)
+            {
+                addresses = new DataArray();
+                interfaces->insert(name, addresses);
+            }
+            addresses->toArray()->append(new DataValue(value.substr(tabPos + 1)));
+        }
+        else if(key == "disk")
+        {
+            // the mount-point is the last field, because it can contain further tabs
+            const size_t firstTab = value.find('\t');
+            const size_t secondTab = value.find('\t', firstTab + 1);
+            if(firstTab == std::string::npos
+                    || secondTab == std::string::npos)
+            {
+                continue;
+            }
+
+            const std::string size = value.substr(0, firstTab);
+            const std::string available = value.substr(firstTab + 1, secondTab - firstTab - 1);
+            DataMap* disk = new DataMap();
+            disk->insert("size_kb", new DataValue(std::strtol(size.c_str(), nullptr, 10)));
+            disk->insert("available_kb",
+                         new DataValue(std::strtol(available.c_str(), nullptr, 10)));
+            disks->insert(value.substr(secondTab + 1), disk);
+        }
+        else if(values.find(key) != values.end())
+        {
+            values[key] = value;
+        }
+    }
+
+    DataMap* os = new DataMap();
+    os->insert("id", new DataValue(values["os.id"]));
+    os->insert("version_id", new DataValue(values["os.version_id"]));
+    os->insert("name", new DataValue(values["os.name"]));
+
+    DataMap* memory = new DataMap();
+    memory->insert("total_kb",
+                   new DataValue(std::strtol(values["memory.total_kb"].c_str(), nullptr, 10)));
+    memory->insert("available_kb",
+                   new DataValue(std::strtol(values["memory.available_kb"].c_str(), nullptr, 10)));
+
+    facts.insert("os", os);
+    facts.insert("hostname", new DataValue(values["hostname"]));
+    facts.insert("kernel", new DataValue(values["kernel"]));
+    facts.insert("memory", memory);
+    facts.insert("disks", disks);
+    facts.insert("interfaces", interfaces);
+    facts.insert("packages", packages);
+
+    return true;
+}
+
+/**
+ * runTask
+ */
+bool
+SshFactsBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
+{
+    const std::string host = blossomLeaf.input.getStringByKey("user")
+                             + "@"
+                             + blossomLeaf.input.getStringByKey("address")
+                             + ":"
+                             + blossomLeaf.input.getStringByKey("port");
+
+    // check if refresh was set
+    bool refresh = false;
+    Kitsunemimi::DataItem* refreshItem = blossomLeaf.input.get("refresh");
+    if(refreshItem != nullptr) {
+        refresh = refreshItem->toValue()->getBool();
+    }
+
+    // facts are only collected once per host and run, if not explicitly requested
+    {
+        std::lock_guard<std::mutex> guard(factsLock);
+
+        std::map<std::string, std::unique_ptr<DataMap>>::const_iterator it;
+        it = factsCache.find(host);
+        if(it != factsCache.end()
+                && refresh == false)
+        {
+            blossomLeaf.output.insert("facts", it->second->copy());
+            return true;
+        }
+    }
+
+    // write script into a local temporary file, which is piped into the ssh-connection and
+    // removed afterwards
+    const std::string scriptPath = createTempPath((bfs::temp_directory_path()
+                                                   / "sakura_facts.sh").string());
+    if(Kitsunemimi::Persistence::writeFile(scriptPath,
+                                           factsScript,
+                                           errorMessage,
+                                           true) == false)
+    {
+        return false;
+    }
+
+    std::string programm = createSshCall(blossomLeaf);
+    programm += "\"sh -s\" < " + scriptPath;
+
+    LOG_DEBUG("run command: " + programm);
+    Kitsunemimi::replaceSubstring(programm, "\"", "\\\"");
+    Kitsunemimi::ProcessResult processResult = runProcess(programm);
+
+    std::string deleteError = "";
+    Kitsunemimi::Persistence::deleteFileOrDir(scriptPath, deleteError);
 
     if(processResult.success == false)
     {
@@ -172,6 +504,19 @@ SshCmdCreateFileBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMes
         return false;
     }
 
+    std::unique_ptr<DataMap> facts(new DataMap());
+    if(parseFacts(processResult.processOutput, *facts, errorMessage) == false) {
+        return false;
+    }
+
+    blossomLeaf.output.insert("facts", facts->copy());
+
+    // update cache
+    {
+        std::lock_guard<std::mutex> guard(factsLock);
+        factsCache[host] = std::move(facts);
+    }
+
     return true;
 }
 
@@ -179,7 +524,7 @@ SshCmdCreateFileBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMes
 // SshScpBlossom
 //==================================================================================================
 SshScpBlossom::SshScpBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("user", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("address", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
@@ -187,45 +532,304 @@ SshScpBlossom::SshScpBlossom()
     validationMap.emplace("source_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("port", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
     validationMap.emplace("ssh_key", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("delta", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("block_size", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("bytes_saved", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
+    validationMap.emplace("file_count", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
+    validationMap.emplace("files_per_second", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
 }
 
 /**
- * runTask
+ * @brief count all files of a path
+ *
+ * @param path file- or directory-path
+ *
+ * @return number of files
+ */
+long
+countFiles(const bfs::path &path)
+{
+    if(bfs::is_directory(path) == false) {
+        return 1;
+    }
+
+    long count = 0;
+    bfs::recursive_directory_iterator end;
+    for(bfs::recursive_directory_iterator it(path); it != end; it++)
+    {
+        if(bfs::is_directory(it->path()) == false) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief collect the source-paths of the blossom, which can be a single path or a list of paths
+ *
+ * @param blossomLeaf actual blossom-leaf
+ * @param sourcePaths reference for the resulting paths
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if one of the paths doesn't exist, else true
  */
 bool
-SshScpBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
+getSourcePaths(BlossomLeaf &blossomLeaf,
+               std::vector<std::string> &sourcePaths,
+               std::string &errorMessage)
+{
+    DataItem* sourceItem = blossomLeaf.input.get("source_path");
+    if(sourceItem->isArray())
+    {
+        for(DataItem* item : sourceItem->toArray()->m_array) {
+            sourcePaths.push_back(item->toString());
+        }
+    }
+    else
+    {
+        sourcePaths.push_back(sourceItem->toString());
+    }
+
+    for(const std::string &sourcePath : sourcePaths)
+    {
+        if(bfs::exists(sourcePath) == false)
+        {
+            errorMessage = "source-path " + sourcePath + " doesn't exist";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief transfer a list of paths or a complete directory as one tar-stream over one
+ *        ssh-connection, instead of one scp-call per file
+ *
+ * @param blossomLeaf actual blossom-leaf
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+runTarTransfer(BlossomLeaf &blossomLeaf,
+               std::string &errorMessage)
 {
     const std::string user = blossomLeaf.input.getStringByKey("user");
     const std::string address = blossomLeaf.input.getStringByKey("address");
     const std::string targetPath = blossomLeaf.input.getStringByKey("target_path");
-    const std::string sourcePath = blossomLeaf.input.getStringByKey("source_path");
     const std::string port = blossomLeaf.input.getStringByKey("port");
     const std::string sshKey = blossomLeaf.input.getStringByKey("ssh_key");
 
+    std::vector<std::string> sourcePaths;
+    if(getSourcePaths(blossomLeaf, sourcePaths, errorMessage) == false) {
+        return false;
+    }
 
-    std::string programm = "scp ";
+    // the content of a directory is transfered directly into the target-path and single
+    // files are transfered by their name into the target-path
+    std::string tarCall = "tar -cpf -";
+    long fileCount = 0;
+    for(const std::string &sourcePath : sourcePaths)
+    {
+        const bfs::path path(sourcePath);
+        if(bfs::is_directory(path)
+                && sourcePaths.size() == 1)
+        {
+            tarCall += " -C " + path.string() + " .";
+        }
+        else
+        {
+            bfs::path parentPath = path.parent_path();
+            if(parentPath.empty()) {
+                parentPath = ".";
+            }
+            tarCall += " -C " + parentPath.string() + " " + path.filename().string();
+        }
 
-    if(port != "") {
-        programm += " -P " + port;
+        fileCount += countFiles(path);
     }
 
+    // with pipefail also a failing local tar fails the transfer, and not only the remote tar
+    std::string programm = "set -o pipefail; " + tarCall + " | ssh";
+    if(port != "") {
+        programm += " -p " + port;
+    }
     if(sshKey != "") {
         programm += " -i " + sshKey;
     }
 
     programm += " ";
-    programm += sourcePath;
+    programm += user;
+    programm += "@";
+    programm += address;
+    programm += " -T \"mkdir -p ";
+    programm += targetPath;
+    programm += " && tar --same-owner -xpf - -C ";
+    programm += targetPath;
+    programm += "\"";
+
+    LOG_DEBUG("run command: " + programm);
+    Kitsunemimi::replaceSubstring(programm, "\"", "\\\"");
+
+    const std::chrono::high_resolution_clock::time_point start =
+            std::chrono::high_resolution_clock::now();
+    Kitsunemimi::ProcessResult processResult = runProcess(programm);
+    const std::chrono::high_resolution_clock::time_point end =
+            std::chrono::high_resolution_clock::now();
+
+    if(processResult.success == false)
+    {
+        errorMessage = processResult.processOutput;
+        return false;
+    }
+
+    // calculate transfer-rate
+    const double duration = std::chrono::duration<double>(end - start).count();
+    double filesPerSecond = static_cast<double>(fileCount);
+    if(duration > 0.0) {
+        filesPerSecond = static_cast<double>(fileCount) / duration;
+    }
+
+    LOG_DEBUG("transfered " + std::to_string(fileCount) + " files with "
+              + std::to_string(filesPerSecond) + " files/s");
+
+    blossomLeaf.output.insert("file_count", new Kitsunemimi::DataValue(fileCount));
+    blossomLeaf.output.insert("files_per_second", new Kitsunemimi::DataValue(filesPerSecond));
+
+    return true;
+}
+
+/**
+ * @brief get a byte-value out of a line of the stats-output of rsync
+ *
+ * @param statsOutput complete output of the rsync-call
+ * @param name name of the value, like for example "Matched data"
+ *
+ * @return found value or 0, if not found
+ */
+long
+getRsyncStatsValue(const std::string &statsOutput,
+                   const std::string &name)
+{
+    const size_t start = statsOutput.find(name + ": ");
+    if(start == std::string::npos) {
+        return 0;
+    }
+
+    // values are printed with thousands-separators, like "1,234,567 bytes"
+    long value = 0;
+    for(size_t pos = start + name.size() + 2; pos < statsOutput.size(); pos++)
+    {
+        const char c = statsOutput.at(pos);
+        if(c >= '0' && c <= '9') {
+            value = value * 10 + (c - '0');
+        } else if(c != ',' && c != '.') {
+            break;
+        }
+    }
+
+    return value;
+}
+
+/**
+ * @brief transfer only the changed blocks of a file, a directory or a list of paths to the
+ *        remote host
+ *
+ * This uses rsync, which compares the blocks of the local and the already existing remote file
+ * with a rolling checksum and only sends the differing blocks, which are merged into the
+ * remote file afterwards. Directories and lists are placed into the target-path like by the
+ * tar-stream.
+ *
+ * @param blossomLeaf actual blossom-leaf
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+runDeltaTransfer(BlossomLeaf &blossomLeaf,
+                 std::string &errorMessage)
+{
+    const std::string user = blossomLeaf.input.getStringByKey("user");
+    const std::string address = blossomLeaf.input.getStringByKey("address");
+    const std::string targetPath = blossomLeaf.input.getStringByKey("target_path");
+    const std::string port = blossomLeaf.input.getStringByKey("port");
+    const std::string sshKey = blossomLeaf.input.getStringByKey("ssh_key");
+    const std::string blockSize = blossomLeaf.input.getStringByKey("block_size");
+
+    std::vector<std::string> sourcePaths;
+    if(getSourcePaths(blossomLeaf, sourcePaths, errorMessage) == false) {
+        return false;
+    }
+    const bool multipleFiles = sourcePaths.size() > 1 || bfs::is_directory(sourcePaths.at(0));
+
+    std::string sshCommand = "ssh";
+    if(port != "") {
+        sshCommand += " -p " + port;
+    }
+    if(sshKey != "") {
+        sshCommand += " -i " + sshKey;
+    }
+
+    // --no-whole-file forces the delta-algorithm, which rsync would skip otherwise for some
+    // targets and --inplace updates only the changed blocks of the remote file
+    std::string programm = "rsync --no-whole-file --inplace --stats";
+    if(blockSize != "") {
+        programm += " --block-size=" + blockSize;
+    }
+
+    // directories and lists keep owner and permissions like the tar-stream and the target-path
+    // is created on the remote host, if necessary
+    if(multipleFiles)
+    {
+        programm += " --archive";
+        programm += " --rsync-path=\"mkdir -p " + targetPath + " && rsync\"";
+    }
+
+    programm += " -e \"";
+    programm += sshCommand;
+    programm += "\"";
+
+    // the trailing slash of a single directory transfers its content into the target-path and
+    // the paths of a list are transfered by their name, like by the tar-stream
+    long fileCount = 0;
+    for(std::string sourcePath : sourcePaths)
+    {
+        fileCount += countFiles(sourcePath);
+
+        while(sourcePath.size() > 1
+              && sourcePath.back() == '/')
+        {
+            sourcePath.pop_back();
+        }
+
+        programm += " " + sourcePath;
+        if(sourcePaths.size() == 1
+                && bfs::is_directory(sourcePath))
+        {
+            programm += "/";
+        }
+    }
+
     programm += " ";
     programm += user;
     programm += "@";
     programm += address;
     programm += ":";
     programm += targetPath;
+    if(multipleFiles) {
+        programm += "/";
+    }
 
     LOG_DEBUG("run command: " + programm);
-
     Kitsunemimi::replaceSubstring(programm, "\"", "\\\"");
-    Kitsunemimi::ProcessResult processResult = Kitsunemimi::runSyncProcess(programm);
+
+    const std::chrono::high_resolution_clock::time_point start =
+            std::chrono::high_resolution_clock::now();
+    Kitsunemimi::ProcessResult processResult = runProcess(programm);
+    const std::chrono::high_resolution_clock::time_point end =
+            std::chrono::high_resolution_clock::now();
 
     if(processResult.success == false)
     {
@@ -233,5 +837,909 @@ SshScpBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
         return false;
     }
 
+    // the matched data are the blocks, which were already on the remote host
+    const long bytesSaved = getRsyncStatsValue(processResult.processOutput, "Matched data");
+    const long bytesSent = getRsyncStatsValue(processResult.processOutput, "Literal data");
+    LOG_DEBUG("delta-transfer of " + std::to_string(fileCount) + " files: "
+              + std::to_string(bytesSent) + " bytes sent, "
+              + std::to_string(bytesSaved) + " bytes saved");
+
+    blossomLeaf.output.insert("bytes_saved", new Kitsunemimi::DataValue(bytesSaved));
+
+    if(multipleFiles)
+    {
+        const double duration = std::chrono::duration<double>(end - start).count();
+        double filesPerSecond = static_cast<double>(fileCount);
+        if(duration > 0.0) {
+            filesPerSecond = static_cast<double>(fileCount) / duration;
+        }
+
+        blossomLeaf.output.insert("file_count", new Kitsunemimi::DataValue(fileCount));
+        blossomLeaf.output.insert("files_per_second", new Kitsunemimi::DataValue(filesPerSecond));
+    }
+
+    return true;
+}
+
+/**
+ * runTask
+ */
+bool
+SshScpBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
+{
+    const std::string user = blossomLeaf.input.getStringByKey("user");
+    const std::string address = blossomLeaf.input.getStringByKey("address");
+    const std::string targetPath = blossomLeaf.input.getStringByKey("target_path");
+    const std::string sourcePath = blossomLeaf.input.getStringByKey("source_path");
+    const std::string port = blossomLeaf.input.getStringByKey("port");
+    const std::string sshKey = blossomLeaf.input.getStringByKey("ssh_key");
+
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
+    // check if delta was set, which is also used for lists of paths and directories
+    Kitsunemimi::DataItem* deltaItem = blossomLeaf.input.get("delta");
+    if(deltaItem != nullptr
+            && deltaItem->toValue()->getBool())
+    {
+        return runDeltaTransfer(blossomLeaf, errorMessage);
+    }
+
+    // lists of paths and directories are transfered as one tar-stream
+    DataItem* sourceItem = blossomLeaf.input.get("source_path");
+    if(sourceItem->isArray()
+            || bfs::is_directory(sourcePath))
+    {
+        return runTarTransfer(blossomLeaf, errorMessage);
+    }
+
+
+    std::string programm = "scp ";
+
+    if(port != "") {
+        programm += " -P " + port;
+    }
+
+    if(sshKey != "") {
+        programm += " -i " + sshKey;
+    }
+
+    programm += " ";
+    programm += sourcePath;
+    programm += " ";
+    programm += user;
+    programm += "@";
+    programm += address;
+    programm += ":";
+    programm += targetPath;
+
+    LOG_DEBUG("run command: " + programm);
+
+    Kitsunemimi::replaceSubstring(programm, "\"", "\\\"");
+    Kitsunemimi::ProcessResult processResult = runProcess(programm);
+
+    if(processResult.success == false)
+    {
+        errorMessage = processResult.processOutput;
+        return false;
+    }
+
+    return true;
+}
+
+//==================================================================================================
+// SshSubtreeBlossom
+//==================================================================================================
+SshSubtreeBlossom::SshSubtreeBlossom()
+    : SakuraBlossom()
+{
+    validationMap.emplace("user", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("address", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("source_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("values", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("target_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("port", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("ssh_key", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("output", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
+    validationMap.emplace("output_values", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
+
+    allowAsyncStart = true;
+}
+
+static std::mutex preparedHostsLock;
+static std::map<std::string, std::mutex> hostLocks;
+static std::set<std::string> preparedHosts;
+
+/**
+ * @brief make sure, that the remote host has the same SakuraTree-binary like the local host,
+ *        which is only checked once per host and run
+ *
+ * @param blossomLeaf actual blossom-leaf with the connection-information
+ * @param remoteBinary path of the binary on the remote host
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+prepareRemoteBinary(BlossomLeaf &blossomLeaf,
+                    const std::string &remoteBinary,
+                    std::string &errorMessage)
+{
+    const std::string host = blossomLeaf.input.getStringByKey("user")
+                             + "@"
+                             + blossomLeaf.input.getStringByKey("address")
+                             + ":"
+                             + blossomLeaf.input.getStringByKey("port");
+
+    // get lock for the host, so parallel subtrees for the same host copy the binary only once
+    std::mutex* hostLock = nullptr;
+    preparedHostsLock.lock();
+    if(preparedHosts.find(host) != preparedHosts.end())
+    {
+        preparedHostsLock.unlock();
+        return true;
+    }
+    hostLock = &hostLocks[host];
+    preparedHostsLock.unlock();
+
+    std::lock_guard<std::mutex> guard(*hostLock);
+
+    // check again, because another thread could have prepared the host while waiting
+    preparedHostsLock.lock();
+    const bool alreadyPrepared = preparedHosts.find(host) != preparedHosts.end();
+    preparedHostsLock.unlock();
+    if(alreadyPrepared) {
+        return true;
+    }
+
+    // compare checksum of the local and the remote binary
+    const std::string localCommand = "md5sum " + SakuraRoot::m_executablePath;
+    LOG_DEBUG("run command: " + localCommand);
+    ProcessResult localResult = runProcess(localCommand);
+    if(localResult.success == false)
+    {
+        errorMessage = localResult.processOutput;
+        return false;
+    }
+    const std::string localChecksum = localResult.processOutput.substr(0, 32);
+
+    std::string programm = createSshCall(blossomLeaf);
+    programm += "\"md5sum " + remoteBinary + "\"";
+    LOG_DEBUG("run command: " + programm);
+    Kitsunemimi::replaceSubstring(programm, "\"", "\\\"");
+    ProcessResult remoteResult = runProcess(programm);
+
+    // copy binary, if not on the remote host or outdated
+    if(remoteResult.success == false
+            || remoteResult.processOutput.substr(0, 32) != localChecksum)
+    {
+        const std::string targetDir = bfs::path(remoteBinary).parent_path().string();
+        programm = createSshCall(blossomLeaf);
+        programm += "\"mkdir -p " + targetDir + " && cat > " + remoteBinary;
+        programm += " && chmod +x " + remoteBinary + "\"";
+        programm += " < " + SakuraRoot::m_executablePath;
+
+        LOG_DEBUG("run command: " + programm);
+        Kitsunemimi::replaceSubstring(programm, "\"", "\\\"");
+        remoteResult = runProcess(programm);
+        if(remoteResult.success == false)
+        {
+            errorMessage = remoteResult.processOutput;
+            return false;
+        }
+    }
+
+    preparedHostsLock.lock();
+    preparedHosts.insert(host);
+    preparedHostsLock.unlock();
+
+    return true;
+}
+
+/**
+ * @brief prepare the run of a subtree on a remote host by copying the binary and writing the
+ *        initial values into a temporary directory, and create the call, which transfers the
+ *        subtree and runs it within one ssh-connection
+ *
+ * @param blossomLeaf actual blossom-leaf with the connection-information and the subtree
+ * @param command reference for the call, which can be given to the process-reactor
+ * @param valuesDir reference for the temporary directory, which has to be deleted by
+ *                  finishSubtree
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+prepareSubtree(BlossomLeaf &blossomLeaf,
+               std::string &command,
+               std::string &valuesDir,
+               std::string &errorMessage)
+{
+    const std::string sourcePath = blossomLeaf.input.getStringByKey("source_path");
+    std::string targetPath = blossomLeaf.input.getStringByKey("target_path");
+    if(targetPath == "") {
+        targetPath = "/tmp/sakura_tree";
+    }
+
+    const std::string remoteBinary = targetPath + "/SakuraTree";
+
+    // get local subtree
+    SakuraLangInterface* interface = SakuraLangInterface::getInstance();
+    const bfs::path subtreePath = interface->getRelativePath(blossomLeaf.blossomPath,
+                                                             bfs::path(sourcePath));
+    if(bfs::exists(subtreePath) == false)
+    {
+        errorMessage = "subtree " + subtreePath.string() + " doesn't exist";
+        return false;
+    }
+
+    // the complete directory of the subtree is transfered, because it can also contain
+    // templates, files and resources
+    bfs::path localDir = subtreePath;
+    std::string treeFile = "";
+    if(bfs::is_directory(subtreePath) == false)
+    {
+        localDir = subtreePath.parent_path();
+        treeFile = subtreePath.filename().string();
+    }
+
+    if(prepareRemoteBinary(blossomLeaf, remoteBinary, errorMessage) == false) {
+        return false;
+    }
+
+    // write initial values into a json-file, which is transfered together with the subtree
+    static std::atomic<uint64_t> subtreeCounter(0);
+    const std::string runId = std::to_string(getpid())
+                              + "_"
+                              + std::to_string(subtreeCounter.fetch_add(1));
+    const bfs::path valuesPath = bfs::temp_directory_path() / ("sakura_values_" + runId);
+    const std::string valuesFile = "sakura_agent_values.json";
+
+    std::string values = "{}";
+    DataItem* valuesItem = blossomLeaf.input.get("values");
+    if(valuesItem != nullptr
+            && valuesItem->isMap())
+    {
+        values = valuesItem->toString();
+    }
+
+    bfs::create_directories(valuesPath);
+    const bool writeResult = Kitsunemimi::Persistence::writeFile((valuesPath / valuesFile).string(),
+                                                                 values,
+                                                                 errorMessage,
+                                                                 true);
+    if(writeResult == false)
+    {
+        std::string deleteError = "";
+        Kitsunemimi::Persistence::deleteFileOrDir(valuesPath.string(), deleteError);
+        return false;
+    }
+
+    // transfer subtree and values as one tar-stream and run the subtree on the remote host
+    // within the same ssh-connection. The remote directory is removed by an exit-trap, so the
+    // exit-status of the subtree is kept as exit-status of the ssh-call. With pipefail also a
+    // failing local tar fails the call.
+    const std::string remoteDir = targetPath + "/subtree_" + runId;
+    std::string programm = "set -o pipefail; ";
+    programm += "tar -C " + localDir.string() + " -cf - . ";
+    programm += "-C " + valuesPath.string() + " " + valuesFile + " | ";
+    programm += createSshCall(blossomLeaf);
+    programm += "\"trap 'rm -rf " + remoteDir + "' EXIT";
+    programm += " ; mkdir -p " + remoteDir;
+    programm += " && tar -C " + remoteDir + " -xf -";
+    programm += " && " + remoteBinary;
+    programm += " --agent-values " + remoteDir + "/" + valuesFile;
+    programm += " " + remoteDir + "/" + treeFile + "\"";
+
+    LOG_DEBUG("run command: " + programm);
+    Kitsunemimi::replaceSubstring(programm, "\"", "\\\"");
+
+    command = programm;
+    valuesDir = valuesPath.string();
+
+    return true;
+}
+
+/**
+ * @brief remove the temporary directory of a subtree-run and check the result of the agent
+ *
+ * @param processResult result of the call of prepareSubtree
+ * @param valuesDir temporary directory of prepareSubtree
+ * @param output reference for the output of the subtree on the remote host
+ * @param outputValues reference for the output-values of the blossoms of the subtree
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if the subtree was successful, else false
+ */
+bool
+finishSubtree(const ProcessResult &processResult,
+              const std::string &valuesDir,
+              std::string &output,
+              DataMap &outputValues,
+              std::string &errorMessage)
+{
+    std::string deleteError = "";
+    Kitsunemimi::Persistence::deleteFileOrDir(valuesDir, deleteError);
+
+    // get result of the agent
+    const size_t resultPos = processResult.processOutput.rfind(AGENT_RESULT_PREFIX);
+    if(resultPos == std::string::npos)
+    {
+        errorMessage = "no result from subtree on remote host:\n" + processResult.processOutput;
+        return false;
+    }
+
+    output = processResult.processOutput.substr(0, resultPos);
+    const size_t jsonStart = resultPos + std::string(AGENT_RESULT_PREFIX).size();
+    const std::string resultString = processResult.processOutput.substr(jsonStart);
+
+    JsonItem result;
+    if(result.parse(resultString, errorMessage) == false) {
+        return false;
+    }
+
+    DataItem* content = result.getItemContent();
+    if(content == nullptr
+            || content->isMap() == false)
+    {
+        errorMessage = "invalid result from subtree on remote host: " + resultString;
+        return false;
+    }
+
+    DataItem* successItem = content->get("success");
+    if(successItem == nullptr
+            || successItem->isValue() == false)
+    {
+        errorMessage = "invalid result from subtree on remote host: " + resultString;
+        return false;
+    }
+
+    if(successItem->toValue()->getBool() == false)
+    {
+        errorMessage = content->toMap()->getStringByKey("error_message");
+        if(errorMessage == "") {
+            errorMessage = "subtree on remote host failed without error-message";
+        }
+        return false;
+    }
+
+    // take over the output-values of the blossoms of the subtree
+    DataItem* outputItem = content->get("output");
+    if(outputItem != nullptr
+            && outputItem->isMap())
+    {
+        std::map<std::string, DataItem*>::const_iterator it;
+        for(it = outputItem->toMap()->m_map.begin();
+            it != outputItem->toMap()->m_map.end();
+            it++)
+        {
+            outputValues.insert(it->first, it->second->copy(), true);
+        }
+    }
+
+    // the result can be printed, before the remote process fails
+    if(processResult.success == false)
+    {
+        errorMessage = "subtree on remote host failed with exit-status "
+                       + std::to_string(processResult.exitStatus)
+                       + ":\n"
+                       + output;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief transfer a subtree to a remote host and run it there within one ssh-connection
+ *
+ * @param blossomLeaf actual blossom-leaf with the connection-information and the subtree
+ * @param output reference for the output of the subtree on the remote host
+ * @param outputValues reference for the output-values of the blossoms of the subtree
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+runSubtree(BlossomLeaf &blossomLeaf,
+           std::string &output,
+           DataMap &outputValues,
+           std::string &errorMessage)
+{
+    std::string command = "";
+    std::string valuesDir = "";
+    if(prepareSubtree(blossomLeaf, command, valuesDir, errorMessage) == false) {
+        return false;
+    }
+
+    const ProcessResult processResult = runProcess(command);
+
+    return finishSubtree(processResult, valuesDir, output, outputValues, errorMessage);
+}
+
+/**
+ * runTask
+ */
+bool
+SshSubtreeBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
+{
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
+    std::string output = "";
+    DataMap* outputValues = new DataMap();
+    if(runSubtree(blossomLeaf, output, *outputValues, errorMessage) == false)
+    {
+        delete outputValues;
+        return false;
+    }
+
+    blossomLeaf.output.insert("output", new Kitsunemimi::DataValue(output));
+    blossomLeaf.output.insert("output_values", outputValues);
+
+    return true;
+}
+
+/**
+ * @brief copy the binary and start the subtree in background, so no thread waits for the end
+ *        of the subtree on the remote host
+ */
+bool
+SshSubtreeBlossom::startTask(BlossomLeaf &blossomLeaf,
+                             const BlossomCallback &callback,
+                             std::string &errorMessage)
+{
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
+    std::string command = "";
+    std::string valuesDir = "";
+    if(prepareSubtree(blossomLeaf, command, valuesDir, errorMessage) == false) {
+        return false;
+    }
+
+    BlossomLeaf* leaf = &blossomLeaf;
+    ProcessReactor* reactor = ProcessReactor::getInstance();
+    const bool started = reactor->startProcess(command,
+                                               [leaf, valuesDir, callback]
+                                               (const ProcessResult &processResult)
+    {
+        std::string output = "";
+        std::string processError = "";
+        DataMap* outputValues = new DataMap();
+        const bool result = finishSubtree(processResult,
+                                          valuesDir,
+                                          output,
+                                          *outputValues,
+                                          processError);
+
+        leaf->output.insert("output", new Kitsunemimi::DataValue(output));
+        leaf->output.insert("output_values", outputValues);
+        callback(result, processError);
+    },
+    errorMessage);
+
+    if(started == false)
+    {
+        std::string deleteError = "";
+        Kitsunemimi::Persistence::deleteFileOrDir(valuesDir, deleteError);
+    }
+
+    return started;
+}
+
+//==================================================================================================
+// SshRollingSubtreeBlossom
+//==================================================================================================
+SshRollingSubtreeBlossom::SshRollingSubtreeBlossom()
+    : SakuraBlossom()
+{
+    validationMap.emplace("user", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("hosts", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("source_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("values", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("target_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("port", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("ssh_key", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("window", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("max_failures", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("output", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
+    validationMap.emplace("failed_hosts", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
+}
+
+/**
+ * @brief get a number of hosts, which is given as absolute number or as percentage of all hosts
+ *        like "10%", where percentages are rounded up
+ *
+ * @param blossomLeaf actual blossom-leaf
+ * @param name name of the input-value
+ * @param numberOfHosts number of all hosts
+ * @param result reference for the resulting number, which is unchanged, if the input is not set
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if the input is invalid, else true
+ */
+bool
+getNumberOfHosts(BlossomLeaf &blossomLeaf,
+                 const std::string &name,
+                 const uint64_t numberOfHosts,
+                 uint64_t &result,
+                 std::string &errorMessage)
+{
+    DataItem* item = blossomLeaf.input.get(name);
+    if(item == nullptr) {
+        return true;
+    }
+
+    if(item->isIntValue())
+    {
+        if(item->toValue()->getLong() < 0)
+        {
+            errorMessage = name + " must be a positive number";
+            return false;
+        }
+
+        result = static_cast<uint64_t>(item->toValue()->getLong());
+        return true;
+    }
+
+    const std::string value = item->toString();
+    if(value.size() < 2
+            || value.size() > 4
+            || value.back() != '%'
+            || value.find_first_not_of("0123456789") != value.size() - 1)
+    {
+        errorMessage = name + " must be a number or a percentage like \"10%\"";
+        return false;
+    }
+
+    const uint64_t percentage = std::stoul(value.substr(0, value.size() - 1));
+    if(percentage > 100)
+    {
+        errorMessage = name + " must not be more than 100%";
+        return false;
+    }
+
+    result = (numberOfHosts * percentage + 99) / 100;
+    return true;
+}
+
+/**
+ * @brief result of the subtree on one host of a rolling run
+ */
+struct RollingHostRun
+{
+    std::string address = "";
+    bool started = false;
+    bool success = false;
+    std::string output = "";
+    std::string errorMessage = "";
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point end;
+};
+
+/**
+ * @brief print for each wave of hosts, which were started one after another in the size of the
+ *        window, how many hosts succeeded or failed and how long it took from the start of the
+ *        first to the end of the last host of the wave
+ *
+ * @param runs results of all hosts in the order of their start
+ * @param window size of the window
+ */
+void
+logWaveSummary(const std::vector<RollingHostRun> &runs,
+               const uint64_t window)
+{
+    const uint64_t numberOfWaves = (runs.size() + window - 1) / window;
+
+    for(uint64_t wave = 0; wave < numberOfWaves; wave++)
+    {
+        const uint64_t first = wave * window;
+        const uint64_t last = std::min(first + window, static_cast<uint64_t>(runs.size()));
+
+        uint64_t succeeded = 0;
+        uint64_t failed = 0;
+        uint64_t skipped = 0;
+        std::chrono::steady_clock::time_point waveStart;
+        std::chrono::steady_clock::time_point waveEnd;
+
+        for(uint64_t i = first; i < last; i++)
+        {
+            const RollingHostRun &run = runs.at(i);
+            if(run.started == false)
+            {
+                skipped++;
+                continue;
+            }
+
+            if(succeeded + failed == 0
+                    || run.start < waveStart)
+            {
+                waveStart = run.start;
+            }
+            if(succeeded + failed == 0
+                    || run.end > waveEnd)
+            {
+                waveEnd = run.end;
+            }
+
+            if(run.success) {
+                succeeded++;
+            } else {
+                failed++;
+            }
+        }
+
+        const long duration =
+                std::chrono::duration_cast<std::chrono::milliseconds>(waveEnd - waveStart).count();
+
+        std::string summary = "rolling_subtree wave " + std::to_string(wave + 1)
+                              + "/" + std::to_string(numberOfWaves)
+                              + " (hosts " + std::to_string(first + 1)
+                              + "-" + std::to_string(last) + "): "
+                              + std::to_string(succeeded) + " succeeded, "
+                              + std::to_string(failed) + " failed";
+        if(skipped > 0) {
+            summary += ", " + std::to_string(skipped) + " skipped";
+        }
+        if(succeeded + failed > 0) {
+            summary += ", " + std::to_string(duration) + " ms";
+        }
+
+        LOG_INFO(summary);
+    }
+}
+
+/**
+ * runTask
+ */
+bool
+SshRollingSubtreeBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
+{
+    DataItem* hostsItem = blossomLeaf.input.get("hosts");
+    if(hostsItem->isArray() == false
+            || hostsItem->size() == 0)
+    {
+        errorMessage = "hosts must be a non-empty list of addresses";
+        return false;
+    }
+
+    std::vector<RollingHostRun> runs;
+    for(DataItem* item : hostsItem->toArray()->m_array)
+    {
+        if(item->isValue() == false)
+        {
+            errorMessage = "hosts must be a list of addresses";
+            return false;
+        }
+
+        RollingHostRun run;
+        run.address = item->toString();
+        runs.push_back(run);
+    }
+
+    // window of hosts, which are processed at the same time, and number of failed hosts, which
+    // are tolerated, before no further host is started
+    uint64_t window = 1;
+    uint64_t maxFailures = 0;
+    if(getNumberOfHosts(blossomLeaf, "window", runs.size(), window, errorMessage) == false
+            || getNumberOfHosts(blossomLeaf,
+                                "max_failures",
+                                runs.size(),
+                                maxFailures,
+                                errorMessage) == false)
+    {
+        return false;
+    }
+    window = std::max(window, static_cast<uint64_t>(1));
+    window = std::min(window, static_cast<uint64_t>(runs.size()));
+
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
+    std::mutex rollingLock;
+    std::condition_variable rollingCv;
+    uint64_t nextHost = 0;
+    uint64_t runningHosts = 0;
+    uint64_t failures = 0;
+    bool aborted = false;
+
+    // end of a host, which is called by the process-reactor or directly, if the subtree
+    // couldn't be started
+    auto finishHost = [&](RollingHostRun &run,
+                          Semaphore* resource,
+                          const std::string &durationKey)
+    {
+        run.end = std::chrono::steady_clock::now();
+        ResourceLimits::getInstance()->release(resource);
+
+        if(run.success)
+        {
+            const long duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                      run.end - run.start).count();
+            DurationHistory::getInstance()->addDuration(durationKey,
+                                                        static_cast<uint64_t>(duration));
+        }
+        else
+        {
+            LOG_ERROR("rolling_subtree: host " + run.address + " failed: " + run.errorMessage);
+        }
+
+        std::lock_guard<std::mutex> guard(rollingLock);
+        runningHosts--;
+        if(run.success == false)
+        {
+            failures++;
+            if(failures > maxFailures
+                    && aborted == false)
+            {
+                aborted = true;
+                const std::string abortMessage = "rolling_subtree: abort after "
+                                                 + std::to_string(failures)
+                                                 + " failed hosts, where at most "
+                                                 + std::to_string(maxFailures)
+                                                 + " are allowed";
+                LOG_ERROR(abortMessage);
+
+                // with fail-fast, the other branches are canceled immediately and not only,
+                // when the last running host of the window is finished
+                FailFast::getInstance()->cancel(abortMessage);
+            }
+        }
+        rollingCv.notify_all();
+    };
+
+    // each slot of the window takes the next host, as soon as its previous host is finished, so
+    // a slow host doesn't block the start of the next hosts like with fixed waves. The subtrees
+    // of the window are running as processes of the process-reactor, so only this thread is
+    // used for the whole window.
+    std::unique_lock<std::mutex> lock(rollingLock);
+    while(true)
+    {
+        rollingCv.wait(lock, [&] { return runningHosts < window; });
+        if(aborted
+                || nextHost >= runs.size()
+                || FailFast::getInstance()->isCanceled())
+        {
+            break;
+        }
+        RollingHostRun &run = runs.at(nextHost);
+        nextHost++;
+        runningHosts++;
+        lock.unlock();
+
+        // the subtree of each host gets the input of the blossom with its own address
+        BlossomLeaf hostLeaf;
+        hostLeaf.blossomType = blossomLeaf.blossomType;
+        hostLeaf.blossomGroupType = blossomLeaf.blossomGroupType;
+        hostLeaf.nameHirarchie = blossomLeaf.nameHirarchie;
+        hostLeaf.blossomName = blossomLeaf.blossomName;
+        hostLeaf.blossomPath = blossomLeaf.blossomPath;
+
+        std::map<std::string, DataItem*>::const_iterator it;
+        for(it = blossomLeaf.input.m_map.begin();
+            it != blossomLeaf.input.m_map.end();
+            it++)
+        {
+            if(it->first != "hosts") {
+                hostLeaf.input.insert(it->first, it->second->copy());
+            }
+        }
+        hostLeaf.input.insert("address", new Kitsunemimi::DataValue(run.address));
+
+        LOG_INFO("rolling_subtree: start host " + run.address);
+
+        // the hosts are not running through the blossom-wrapper, so the durations are
+        // recorded here per host
+        DurationHistory* history = DurationHistory::getInstance();
+        const std::string durationKey = getDurationKey("ssh", "rolling_subtree", hostLeaf);
+        const uint64_t expectedDuration = history->getExpectedDuration(durationKey);
+
+        ResourceLimits* resourceLimits = ResourceLimits::getInstance();
+        Semaphore* resource = nullptr;
+        const bool acquired = resourceLimits->acquire("ssh",
+                                                      "subtree",
+                                                      hostLeaf.input,
+                                                      resource,
+                                                      run.errorMessage,
+                                                      expectedDuration);
+
+        run.started = true;
+        run.start = std::chrono::steady_clock::now();
+
+        std::string command = "";
+        std::string valuesDir = "";
+        bool started = acquired && prepareSubtree(hostLeaf, command, valuesDir, run.errorMessage);
+        if(started)
+        {
+            RollingHostRun* runPtr = &run;
+            ProcessReactor* reactor = ProcessReactor::getInstance();
+            started = reactor->startProcess(command,
+                                            [&finishHost, runPtr, resource, durationKey, valuesDir]
+                                            (const ProcessResult &processResult)
+            {
+                DataMap outputValues;
+                runPtr->success = finishSubtree(processResult,
+                                                valuesDir,
+                                                runPtr->output,
+                                                outputValues,
+                                                runPtr->errorMessage);
+                finishHost(*runPtr, resource, durationKey);
+            },
+            run.errorMessage);
+
+            if(started == false)
+            {
+                std::string deleteError = "";
+                Kitsunemimi::Persistence::deleteFileOrDir(valuesDir, deleteError);
+            }
+        }
+
+        if(started == false)
+        {
+            run.success = false;
+            finishHost(run, resource, durationKey);
+        }
+
+        lock.lock();
+    }
+
+    // wait for the hosts, which are still running
+    rollingCv.wait(lock, [&] { return runningHosts == 0; });
+    lock.unlock();
+
+    logWaveSummary(runs, window);
+
+    // collect results
+    DataMap* outputs = new DataMap();
+    DataArray* failedHosts = new DataArray();
+    std::string failedMessages = "";
+    uint64_t skipped = 0;
+
+    for(const RollingHostRun &run : runs)
+    {
+        if(run.started == false)
+        {
+            skipped++;
+            continue;
+        }
+
+        if(run.success)
+        {
+            outputs->insert(run.address, new Kitsunemimi::DataValue(run.output));
+        }
+        else
+        {
+            failedHosts->append(new Kitsunemimi::DataValue(run.address));
+            failedMessages += "\n" + run.address + ": " + run.errorMessage;
+        }
+    }
+
+    blossomLeaf.output.insert("output", outputs);
+    blossomLeaf.output.insert("failed_hosts", failedHosts);
+
+    if(aborted)
+    {
+        errorMessage = "rolling_subtree aborted after " + std::to_string(failures)
+                       + " failed hosts, " + std::to_string(skipped) + " hosts were skipped:"
+                       + failedMessages;
+        return false;
+    }
+
+    if(skipped > 0)
+    {
+        errorMessage = "rolling_subtree canceled, " + std::to_string(skipped)
+                       + " hosts were skipped:" + failedMessages;
+        return false;
+    }
+
     return true;
 }
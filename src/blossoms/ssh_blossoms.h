@@ -24,26 +24,32 @@
 #define SSH_BLOSSOMS_H
 
 #include <common.h>
+#include <blossoms/sakura_blossom.h>
 #include <unistd.h>
 
+const std::string createSshCall(BlossomLeaf &blossomLeaf);
+
 //==================================================================================================
 // SshCmdBlossom
 //==================================================================================================
 class SshCmdBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     SshCmdBlossom();
 
 protected:
     bool runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage);
+    bool startTask(BlossomLeaf &blossomLeaf,
+                   const BlossomCallback &callback,
+                   std::string &errorMessage);
 };
 
 //==================================================================================================
 // SshCmdCreateFileBlossom
 //==================================================================================================
 class SshCmdCreateFileBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     SshCmdCreateFileBlossom();
@@ -52,11 +58,24 @@ protected:
     bool runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage);
 };
 
+//==================================================================================================
+// SshFactsBlossom
+//==================================================================================================
+class SshFactsBlossom
+        : public SakuraBlossom
+{
+public:
+    SshFactsBlossom();
+
+protected:
+    bool runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage);
+};
+
 //==================================================================================================
 // SshScpBlossom
 //==================================================================================================
 class SshScpBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     SshScpBlossom();
@@ -65,5 +84,33 @@ protected:
     bool runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage);
 };
 
+//==================================================================================================
+// SshSubtreeBlossom
+//==================================================================================================
+class SshSubtreeBlossom
+        : public SakuraBlossom
+{
+public:
+    SshSubtreeBlossom();
+
+protected:
+    bool runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage);
+    bool startTask(BlossomLeaf &blossomLeaf,
+                   const BlossomCallback &callback,
+                   std::string &errorMessage);
+};
+
+//==================================================================================================
+// SshRollingSubtreeBlossom
+//==================================================================================================
+class SshRollingSubtreeBlossom
+        : public SakuraBlossom
+{
+public:
+    SshRollingSubtreeBlossom();
+
+protected:
+    bool runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage);
+};
 
 #endif // SSH_BLOSSOMS_H
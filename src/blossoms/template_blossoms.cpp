@@ -24,12 +24,19 @@
 
 #include <libKitsunemimiSakuraLang/sakura_lang_interface.h>
 
+#include <libKitsunemimiCommon/common_methods/string_methods.h>
+
 #include <libKitsunemimiPersistence/files/file_methods.h>
 #include <libKitsunemimiPersistence/files/text_file.h>
 
 #include <libKitsunemimiJinja2/jinja2_converter.h>
 
 #include <sakura_root.h>
+#include <blossoms/ssh_blossoms.h>
+#include <caches/ini_cache.h>
+#include <helper/file_helper.h>
+#include <processing/process_reactor.h>
+#include <processing/thread_pool.h>
 
 using Kitsunemimi::Jinja2::Jinja2Converter;
 
@@ -58,12 +65,13 @@ convertTemplate(std::string &output,
         return false;
     }
 
-    // create file-content form template
-    Jinja2Converter* converter = Jinja2Converter::getInstance();
-    const bool jinja2Result = converter->convert(output,
-                                                 templateCont,
-                                                 &values,
-                                                 errorMessage);
+    // create file-content form template. Each thread has its own converter, so templates can
+    // be rendered in parallel without sharing the global converter-instance.
+    static thread_local Jinja2Converter converter;
+    const bool jinja2Result = converter.convert(output,
+                                                templateCont,
+                                                &values,
+                                                errorMessage);
 
     if(jinja2Result == false)
     {
@@ -99,7 +107,7 @@ getAbsoluteTemplatePath(BlossomLeaf &blossomLeaf)
 // TemplateCreateFileBlossom
 //==================================================================================================
 TemplateCreateFileBlossom::TemplateCreateFileBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("source_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("dest_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
@@ -119,6 +127,11 @@ TemplateCreateFileBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorM
     const std::string owner = blossomLeaf.input.getStringByKey("owner");
     const std::string permission = blossomLeaf.input.getStringByKey("permission");
 
+    // write pending ini-changes of the file back, before it is overwritten
+    if(IniCache::getInstance()->flush(destinationPath, errorMessage) == false) {
+        return false;
+    }
+
     std::string convertedContent = "";
     bool ret = convertTemplate(convertedContent,
                                templatePath,
@@ -128,22 +141,11 @@ TemplateCreateFileBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorM
         return false;
     }
 
-    // check if template-file already exist
-    if(bfs::exists(destinationPath))
-    {
-        // read the already existing file and compare it the current file-content
-        std::string existingFileContent;
-        Kitsunemimi::Persistence::readFile(existingFileContent, destinationPath, errorMessage);
-        if(convertedContent == existingFileContent) {
-            return true;
-        }
-    }
-
-    // write converted template into the file
-    ret = Kitsunemimi::Persistence::writeFile(destinationPath,
-                                              convertedContent,
-                                              errorMessage,
-                                              true);
+    // write converted template chunk by chunk over a temporary file into the destination,
+    // without reading the already existing file into memory
+    uint64_t contentHash = 0;
+    bool changed = false;
+    ret = writeFileAtomic(destinationPath, convertedContent, contentHash, changed, errorMessage);
     if(ret == false)
     {
         errorMessage = "couldn't write template-file to "
@@ -153,6 +155,15 @@ TemplateCreateFileBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorM
         return false;
     }
 
+    // the rendered content is not required anymore
+    const uint64_t contentSize = convertedContent.size();
+    std::string().swap(convertedContent);
+
+    // nothing to do, if file already had the same content
+    if(changed == false) {
+        return true;
+    }
+
     // set owner if defined
     if(owner != "")
     {
@@ -172,14 +183,308 @@ TemplateCreateFileBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorM
     }
 
     // post-check
-    std::string fileContent = "";
-    ret = Kitsunemimi::Persistence::readFile(fileContent, destinationPath, errorMessage);
+    uint64_t fileHash = 0;
+    ret = hashFile(destinationPath, fileHash, errorMessage);
     if(ret == false
-            || convertedContent != fileContent)
+            || bfs::file_size(destinationPath) != contentSize
+            || fileHash != contentHash)
+    {
+        errorMessage = "content of " + destinationPath + " is not the rendered template";
+        return false;
+    }
+
+    return true;
+}
+
+//==================================================================================================
+// TemplateCreateTreeBlossom
+//==================================================================================================
+TemplateCreateTreeBlossom::TemplateCreateTreeBlossom()
+    : SakuraBlossom()
+{
+    validationMap.emplace("source_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("dest_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("owner", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("permission", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("variables", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("changed_files", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
+}
+
+/**
+ * @brief render a template into a file of the destination-tree
+ *
+ * @param templatePath absolute path of the template
+ * @param destinationPath path of the rendered file
+ * @param values value-item-map with all values, which should be inserted into the template
+ * @param changed reference, which is set to true, if the file was changed
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+createTreeFile(const std::string &templatePath,
+               const std::string &destinationPath,
+               DataMap &values,
+               bool &changed,
+               std::string &errorMessage)
+{
+    std::string convertedContent = "";
+    if(convertTemplate(convertedContent, templatePath, values, errorMessage) == false) {
+        return false;
+    }
+
+    // create parent-directories for templates in sub-directories
+    boost::system::error_code ec;
+    bfs::create_directories(bfs::path(destinationPath).parent_path(), ec);
+    if(ec.failed())
+    {
+        errorMessage = "couldn't create directory for " + destinationPath;
+        return false;
+    }
+
+    uint64_t contentHash = 0;
+    if(writeFileAtomic(destinationPath, convertedContent, contentHash, changed, errorMessage)
+            == false)
+    {
+        errorMessage = "couldn't write template-file to "
+                       + destinationPath +
+                       " with reason: "
+                       + errorMessage;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * runTask
+ */
+bool
+TemplateCreateTreeBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
+{
+    const bfs::path templateDir = getAbsoluteTemplatePath(blossomLeaf);
+    const std::string destinationPath = blossomLeaf.input.getStringByKey("dest_path");
+    const std::string owner = blossomLeaf.input.getStringByKey("owner");
+    const std::string permission = blossomLeaf.input.getStringByKey("permission");
+    DataMap* values = blossomLeaf.input.get("variables")->toMap();
+
+    // write pending ini-changes back, before the files are accessed by something else
+    if(IniCache::getInstance()->flushAll(errorMessage) == false) {
+        return false;
+    }
+
+    // precheck
+    if(bfs::is_directory(templateDir) == false)
+    {
+        errorMessage = "template-directory " + templateDir.string() + " doesn't exist";
+        return false;
+    }
+
+    // collect all templates of the directory
+    std::vector<std::string> templatePaths;
+    std::vector<std::string> destinationPaths;
+    bfs::recursive_directory_iterator end;
+    for(bfs::recursive_directory_iterator it(templateDir); it != end; it++)
+    {
+        if(bfs::is_regular_file(it->path()) == false) {
+            continue;
+        }
+
+        // remove the j2-extension for the rendered file
+        std::string relativePath = bfs::relative(it->path(), templateDir).string();
+        if(it->path().extension() == ".j2") {
+            relativePath = relativePath.substr(0, relativePath.size() - 3);
+        }
+
+        templatePaths.push_back(it->path().string());
+        destinationPaths.push_back((bfs::path(destinationPath) / relativePath).string());
+    }
+
+    // render all templates in parallel, where each chunk of templates collects its results in
+    // its own buffer, which are merged in the order of the chunks afterwards
+    struct ChunkResult
+    {
+        std::vector<uint64_t> changedIndexes;
+        std::string errorMessage = "";
+    };
+
+    ThreadPool* threadPool = ThreadPool::getInstance();
+    const uint64_t numberOfTemplates = templatePaths.size();
+    std::vector<ChunkResult> chunkResults(threadPool->getNumberOfChunks(numberOfTemplates));
+    threadPool->parallelForChunks(numberOfTemplates,
+                                  [&](const uint64_t chunkId,
+                                      const uint64_t start,
+                                      const uint64_t end)
+    {
+        ChunkResult &chunkResult = chunkResults[chunkId];
+        for(uint64_t i = start; i < end; i++)
+        {
+            bool fileChanged = false;
+            if(createTreeFile(templatePaths[i],
+                              destinationPaths[i],
+                              *values,
+                              fileChanged,
+                              chunkResult.errorMessage) == false)
+            {
+                return;
+            }
+
+            if(fileChanged) {
+                chunkResult.changedIndexes.push_back(i);
+            }
+        }
+    });
+
+    // check results and set owner and permission for changed files
+    DataArray* changedFiles = new DataArray();
+    for(const ChunkResult &chunkResult : chunkResults)
+    {
+        if(chunkResult.errorMessage != "")
+        {
+            errorMessage = chunkResult.errorMessage;
+            delete changedFiles;
+            return false;
+        }
+
+        for(const uint64_t i : chunkResult.changedIndexes)
+        {
+            if(owner != "")
+            {
+                const std::string command = "chown " + owner + ":" + owner + " "
+                                            + destinationPaths[i];
+                if(SakuraRoot::m_root->runCommand(command, errorMessage) == false)
+                {
+                    delete changedFiles;
+                    return false;
+                }
+            }
+
+            if(permission != "")
+            {
+                const std::string command = "chmod " + permission + " " + destinationPaths[i];
+                if(SakuraRoot::m_root->runCommand(command, errorMessage) == false)
+                {
+                    delete changedFiles;
+                    return false;
+                }
+            }
+
+            changedFiles->append(new DataValue(destinationPaths[i]));
+        }
+    }
+
+    blossomLeaf.output.insert("changed_files", changedFiles);
+
+    return true;
+}
+
+//==================================================================================================
+// TemplateCreateRemoteFileBlossom
+//==================================================================================================
+TemplateCreateRemoteFileBlossom::TemplateCreateRemoteFileBlossom()
+    : SakuraBlossom()
+{
+    validationMap.emplace("source_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("dest_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("user", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("address", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("port", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("ssh_key", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("owner", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("permission", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("variables", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("changed", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
+}
+
+/**
+ * runTask
+ */
+bool
+TemplateCreateRemoteFileBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
+{
+    const std::string templatePath = getAbsoluteTemplatePath(blossomLeaf);
+    const std::string destinationPath = blossomLeaf.input.getStringByKey("dest_path");
+    const std::string owner = blossomLeaf.input.getStringByKey("owner");
+    const std::string permission = blossomLeaf.input.getStringByKey("permission");
+
+    std::string convertedContent = "";
+    bool ret = convertTemplate(convertedContent,
+                               templatePath,
+                               *blossomLeaf.input.get("variables")->toMap(),
+                               errorMessage);
+    if(ret == false) {
+        return false;
+    }
+
+    // write rendered template into a local temporary file, which is streamed into the
+    // ssh-connection, so the content is not part of the command and only exist once in memory
+    const std::string localPath = createTempPath((bfs::temp_directory_path()
+                                                  / "sakura_remote_template").string());
+    uint64_t contentHash = 0;
+    bool changed = false;
+    ret = writeFileAtomic(localPath, convertedContent, contentHash, changed, errorMessage);
+    std::string().swap(convertedContent);
+    if(ret == false) {
+        return false;
+    }
+
+    std::string deleteError = "";
+
+    // the remote host uses sha256sum for the comparison, so the same is used locally
+    const std::string hashCommand = "sha256sum " + localPath;
+    LOG_DEBUG("run command: " + hashCommand);
+    ProcessResult hashResult = runProcess(hashCommand);
+    if(hashResult.success == false)
+    {
+        Kitsunemimi::Persistence::deleteFileOrDir(localPath, deleteError);
+        errorMessage = hashResult.processOutput;
+        return false;
+    }
+    const std::string localChecksum = hashResult.processOutput.substr(0, 64);
+
+    // compare checksum of the remote file without stdin, so the content is only transfered,
+    // if the checksum is different. The file is written with sudo, so it is also read with sudo.
+    std::string programm = createSshCall(blossomLeaf);
+    programm += "\"echo '" + localChecksum + "  " + destinationPath + "'";
+    programm += " | sudo sha256sum -c --status 2>/dev/null\"";
+
+    LOG_DEBUG("run command: " + programm);
+    Kitsunemimi::replaceSubstring(programm, "\"", "\\\"");
+    ProcessResult processResult = runProcess(programm);
+    if(processResult.success)
     {
+        Kitsunemimi::Persistence::deleteFileOrDir(localPath, deleteError);
+        blossomLeaf.output.insert("changed", new DataValue(false));
+        return true;
+    }
+
+    // transfer the file over a temporary file, so the destination is replaced atomically
+    const std::string remoteTemp = destinationPath + ".sakura_tmp";
+    programm = createSshCall(blossomLeaf);
+    programm += "\"sudo tee " + remoteTemp + " > /dev/null";
+    programm += " && sudo mv " + remoteTemp + " " + destinationPath;
+    if(owner != "") {
+        programm += " && sudo chown " + owner + ":" + owner + " " + destinationPath;
+    }
+    if(permission != "") {
+        programm += " && sudo chmod " + permission + " " + destinationPath;
+    }
+    programm += "\"";
+    programm += " < " + localPath;
+
+    LOG_DEBUG("run command: " + programm);
+    Kitsunemimi::replaceSubstring(programm, "\"", "\\\"");
+    processResult = runProcess(programm);
+    Kitsunemimi::Persistence::deleteFileOrDir(localPath, deleteError);
+
+    if(processResult.success == false)
+    {
+        errorMessage = processResult.processOutput;
         return false;
     }
 
+    blossomLeaf.output.insert("changed", new DataValue(true));
+
     return true;
 }
 
@@ -187,7 +492,7 @@ TemplateCreateFileBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorM
 // TemplateCreateStringBlossom
 //==================================================================================================
 TemplateCreateStringBlossom::TemplateCreateStringBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("source_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("variables", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
@@ -24,12 +24,13 @@
 #define TEMPLATE_BLOSSOMS_H
 
 #include <common.h>
+#include <blossoms/sakura_blossom.h>
 
 //==================================================================================================
 // TemplateCreateFileBlossom
 //==================================================================================================
 class TemplateCreateFileBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 
 public:
@@ -39,11 +40,39 @@ protected:
     bool runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage);
 };
 
+//==================================================================================================
+// TemplateCreateTreeBlossom
+//==================================================================================================
+class TemplateCreateTreeBlossom
+        : public SakuraBlossom
+{
+
+public:
+    TemplateCreateTreeBlossom();
+
+protected:
+    bool runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage);
+};
+
+//==================================================================================================
+// TemplateCreateRemoteFileBlossom
+//==================================================================================================
+class TemplateCreateRemoteFileBlossom
+        : public SakuraBlossom
+{
+
+public:
+    TemplateCreateRemoteFileBlossom();
+
+protected:
+    bool runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage);
+};
+
 //==================================================================================================
 // TemplateCreateStringBlossom
 //==================================================================================================
 class TemplateCreateStringBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 
 public:
@@ -22,6 +22,11 @@
 
 #include "text_blossoms.h"
 
+#include <caches/ini_cache.h>
+#include <helper/file_helper.h>
+#include <processing/append_queue.h>
+#include <processing/output_bindings.h>
+
 #include <libKitsunemimiPersistence/files/file_methods.h>
 #include <libKitsunemimiPersistence/files/text_file.h>
 
@@ -52,11 +57,43 @@ checkFile(const std::string &filePath,
     return true;
 }
 
+/**
+ * @brief get an optional positive number from the input-values of a blossom
+ *
+ * @param blossomLeaf blossom-leaf with the input-values
+ * @param name name of the input-value
+ * @param result reference for the number, which is not changed, if the value is not set
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if the value is not a positive number, else true
+ */
+bool
+getPositiveNumber(BlossomLeaf &blossomLeaf,
+                  const std::string &name,
+                  uint64_t &result,
+                  std::string &errorMessage)
+{
+    DataItem* item = blossomLeaf.input.get(name);
+    if(item == nullptr) {
+        return true;
+    }
+
+    if(item->isIntValue() == false
+            || item->toValue()->getLong() < 0)
+    {
+        errorMessage = name + " must be a positive number";
+        return false;
+    }
+
+    result = static_cast<uint64_t>(item->toValue()->getLong());
+    return true;
+}
+
 //==================================================================================================
 // TextAppendBlossom
 //==================================================================================================
 TextAppendBlossom::TextAppendBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("file_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("text", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
@@ -71,22 +108,125 @@ TextAppendBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
     const std::string filePath = blossomLeaf.input.getStringByKey("file_path");
     const std::string newText = blossomLeaf.input.getStringByKey("text");
 
+    // write pending ini-changes of the file back, before it is accessed
+    if(IniCache::getInstance()->flush(filePath, errorMessage) == false) {
+        return false;
+    }
+
     const bool ret = checkFile(filePath, errorMessage);
     if(ret == false) {
         return false;
     }
 
-    return Kitsunemimi::Persistence::appendText(filePath, newText, errorMessage);
+    // appends of parallel branches to the same file are serialized and written together
+    return AppendQueue::getInstance()->appendText(filePath, newText, errorMessage);
+}
+
+//==================================================================================================
+// TextEnsureLineBlossom
+//==================================================================================================
+TextEnsureLineBlossom::TextEnsureLineBlossom()
+    : SakuraBlossom()
+{
+    validationMap.emplace("file_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("line", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("regex", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("lines", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("changed", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
+}
+
+/**
+ * @brief runTask
+ */
+bool
+TextEnsureLineBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
+{
+    const std::string filePath = blossomLeaf.input.getStringByKey("file_path");
+    DataItem* linesItem = blossomLeaf.input.get("lines");
+
+    // write pending ini-changes of the file back, before it is accessed
+    if(IniCache::getInstance()->flush(filePath, errorMessage) == false) {
+        return false;
+    }
+
+    // collect lines, where a list contains plain lines and a map contains regex and line
+    std::vector<EnsureLineRequest> requests;
+    if(linesItem == nullptr)
+    {
+        if(blossomLeaf.input.get("line") == nullptr)
+        {
+            errorMessage = "either line or lines must be set";
+            return false;
+        }
+
+        EnsureLineRequest request;
+        request.line = blossomLeaf.input.getStringByKey("line");
+        request.regex = blossomLeaf.input.getStringByKey("regex");
+        requests.push_back(request);
+    }
+    else if(linesItem->isArray())
+    {
+        DataArray* lines = linesItem->toArray();
+        for(uint64_t i = 0; i < lines->size(); i++)
+        {
+            EnsureLineRequest request;
+            request.line = lines->get(i)->toString();
+            requests.push_back(request);
+        }
+    }
+    else if(linesItem->isMap())
+    {
+        DataMap* lines = linesItem->toMap();
+        const std::vector<std::string> regexList = lines->getKeys();
+        for(const std::string &regex : regexList)
+        {
+            EnsureLineRequest request;
+            request.regex = regex;
+            request.line = lines->getStringByKey(regex);
+            requests.push_back(request);
+        }
+    }
+    else
+    {
+        errorMessage = "lines must be a list of lines or a map of regex and line";
+        return false;
+    }
+
+    // lines must not contain line-breaks, because the file is compared line by line
+    for(const EnsureLineRequest &request : requests)
+    {
+        if(request.line.find('\n') != std::string::npos)
+        {
+            errorMessage = "line \"" + request.line + "\" contains a line-break";
+            return false;
+        }
+    }
+
+    uint64_t addedLines = 0;
+    uint64_t replacedLines = 0;
+    if(ensureLinesInFile(filePath, requests, addedLines, replacedLines, errorMessage) == false) {
+        return false;
+    }
+
+    const bool changed = addedLines > 0 || replacedLines > 0;
+    blossomLeaf.output.insert("changed", new Kitsunemimi::DataValue(changed));
+
+    return true;
 }
 
 //==================================================================================================
 // TextReadBlossom
 //==================================================================================================
 TextReadBlossom::TextReadBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("file_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
-    validationMap.emplace("text", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, true));
+    validationMap.emplace("offset", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("length", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("head_lines", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("tail_lines", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("text", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
+    validationMap.emplace("lines", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
 }
 
 /**
@@ -97,18 +237,72 @@ TextReadBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 {
     const std::string filePath = blossomLeaf.input.getStringByKey("file_path");
 
+    // write pending ini-changes of the file back, before it is accessed
+    if(IniCache::getInstance()->flush(filePath, errorMessage) == false) {
+        return false;
+    }
+
     const bool ret = checkFile(filePath, errorMessage);
     if(ret == false) {
         return false;
     }
 
-    std::string fileContent = "";
-    const bool result = Kitsunemimi::Persistence::readFile(fileContent, filePath, errorMessage);
+    // get range of the file to read
+    FileReadRequest request;
+    if(getPositiveNumber(blossomLeaf, "offset", request.offset, errorMessage) == false
+            || getPositiveNumber(blossomLeaf, "length", request.length, errorMessage) == false
+            || getPositiveNumber(blossomLeaf,
+                                 "head_lines",
+                                 request.headLines,
+                                 errorMessage) == false
+            || getPositiveNumber(blossomLeaf,
+                                 "tail_lines",
+                                 request.tailLines,
+                                 errorMessage) == false)
+    {
+        return false;
+    }
+
+    if(request.headLines > 0
+            && request.tailLines > 0)
+    {
+        errorMessage = "head_lines and tail_lines can not be used together";
+        return false;
+    }
 
+    std::string fileContent = "";
+    const bool result = readFilePart(filePath, request, fileContent, errorMessage);
     if(result == false) {
         return false;
     }
 
+    // split content into lines, so they can be used in a parallel_for, but only if lines were
+    // requested or are used by the tree, because this copies the whole content again
+    const bool linesRequested = request.headLines > 0
+                                || request.tailLines > 0
+                                || OutputBindings::getInstance()->isOutputBound(
+                                       blossomLeaf.blossomPath,
+                                       blossomLeaf.blossomName,
+                                       "read",
+                                       "lines");
+    if(linesRequested)
+    {
+        DataArray* lines = new DataArray();
+        uint64_t lineStart = 0;
+        while(lineStart < fileContent.size())
+        {
+            uint64_t lineEnd = fileContent.find('\n', lineStart);
+            if(lineEnd == std::string::npos) {
+                lineEnd = fileContent.size();
+            }
+
+            lines->append(new Kitsunemimi::DataValue(fileContent.substr(lineStart,
+                                                                        lineEnd - lineStart)));
+            lineStart = lineEnd + 1;
+        }
+        blossomLeaf.output.insert("lines", lines);
+    }
+
     blossomLeaf.output.insert("text", new Kitsunemimi::DataValue(fileContent));
 
     return true;
@@ -118,11 +312,13 @@ TextReadBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
 // TextReplaceBlossom
 //==================================================================================================
 TextReplaceBlossom::TextReplaceBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("file_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("old_text", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("new_text", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
+    validationMap.emplace("use_regex", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+    validationMap.emplace("match_count", BlossomValidDef(IO_ValueType::OUTPUT_TYPE, false));
 }
 
 /**
@@ -135,24 +331,47 @@ TextReplaceBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
     const std::string oldText = blossomLeaf.input.getStringByKey("old_text");
     const std::string newText = blossomLeaf.input.getStringByKey("new_text");
 
+    // write pending ini-changes of the file back, before it is accessed
+    if(IniCache::getInstance()->flush(filePath, errorMessage) == false) {
+        return false;
+    }
+
     const bool ret = checkFile(filePath, errorMessage);
     if(ret == false) {
         return false;
     }
 
-    const bool result = Kitsunemimi::Persistence::replaceContent(filePath,
-                                                                 oldText,
-                                                                 newText,
-                                                                 errorMessage);
+    // check if use_regex was set
+    bool useRegex = false;
+    DataItem* regexItem = blossomLeaf.input.get("use_regex");
+    if(regexItem != nullptr) {
+        useRegex = regexItem->toValue()->getBool();
+    }
+
+    // replace chunk by chunk over a temporary file, to handle also very large files
+    uint64_t matchCount = 0;
+    bool result = false;
+    if(useRegex) {
+        result = replaceRegexInFile(filePath, oldText, newText, matchCount, errorMessage);
+    } else {
+        result = replaceInFile(filePath, oldText, newText, matchCount, errorMessage);
+    }
+
+    if(result == false) {
+        return false;
+    }
+
+    blossomLeaf.output.insert("match_count",
+                              new Kitsunemimi::DataValue(static_cast<long>(matchCount)));
 
-    return result;
+    return true;
 }
 
 //==================================================================================================
 // TextWriteBlossom
 //==================================================================================================
 TextWriteBlossom::TextWriteBlossom()
-    : Blossom()
+    : SakuraBlossom()
 {
     validationMap.emplace("file_path", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
     validationMap.emplace("text", BlossomValidDef(IO_ValueType::INPUT_TYPE, true));
@@ -167,5 +386,10 @@ TextWriteBlossom::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
     const std::string filePath = blossomLeaf.input.getStringByKey("file_path");
     const std::string text = blossomLeaf.input.getStringByKey("text");
 
+    // write pending ini-changes of the file back, before it is accessed
+    if(IniCache::getInstance()->flush(filePath, errorMessage) == false) {
+        return false;
+    }
+
     return Kitsunemimi::Persistence::writeFile(filePath, text, errorMessage);
 }
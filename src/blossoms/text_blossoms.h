@@ -24,12 +24,13 @@
 #define TEXT_BLOSSOMS_H
 
 #include <common.h>
+#include <blossoms/sakura_blossom.h>
 
 //==================================================================================================
 // TextAppendBlossom
 //==================================================================================================
 class TextAppendBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     TextAppendBlossom();
@@ -38,11 +39,24 @@ protected:
     bool runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage);
 };
 
+//==================================================================================================
+// TextEnsureLineBlossom
+//==================================================================================================
+class TextEnsureLineBlossom
+        : public SakuraBlossom
+{
+public:
+    TextEnsureLineBlossom();
+
+protected:
+    bool runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage);
+};
+
 //==================================================================================================
 // TextReadBlossom
 //==================================================================================================
 class TextReadBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     TextReadBlossom();
@@ -55,7 +69,7 @@ protected:
 // TextReplaceBlossom
 //==================================================================================================
 class TextReplaceBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     TextReplaceBlossom();
@@ -68,7 +82,7 @@ protected:
 // TextWriteBlossom
 //==================================================================================================
 class TextWriteBlossom
-        : public Kitsunemimi::Sakura::Blossom
+        : public SakuraBlossom
 {
 public:
     TextWriteBlossom();
@@ -0,0 +1,305 @@
+/**
+ * @file        ini_cache.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "ini_cache.h"
+
+#include <helper/file_helper.h>
+
+#include <libKitsunemimiIni/ini_item.h>
+#include <libKitsunemimiPersistence/files/text_file.h>
+
+using Kitsunemimi::Ini::IniItem;
+
+IniCache* IniCache::m_instance = nullptr;
+
+/**
+ * @brief constructor
+ */
+IniCache::IniCache() {}
+
+/**
+ * @brief get instance of the ini-cache, which is shared by all threads
+ *
+ * @return pointer to the cache
+ */
+IniCache*
+IniCache::getInstance()
+{
+    static std::mutex instanceLock;
+    std::lock_guard<std::mutex> guard(instanceLock);
+
+    if(m_instance == nullptr) {
+        m_instance = new IniCache();
+    }
+
+    return m_instance;
+}
+
+/**
+ * @brief get the parsed ini-file and lock it for the calling thread, until unlockItem is
+ *        called. The file is only parsed again, if it was changed since the last access.
+ *
+ * @param filePath path of the ini-file
+ * @param errorMessage reference for error-message
+ *
+ * @return pointer to the locked ini-item, or nullptr, if the file couldn't be read or parsed
+ */
+IniItem*
+IniCache::lockItem(const std::string &filePath,
+                   std::string &errorMessage)
+{
+    IniEntry* entry = getEntry(resolveFilePath(filePath));
+    entry->lock.lock();
+
+    struct stat fileStat;
+    if(stat(filePath.c_str(), &fileStat) != 0)
+    {
+        entry->lock.unlock();
+        errorMessage = "file-path " + filePath + " doesn't exist";
+        return nullptr;
+    }
+
+    // check if the file was changed by something else than the cache
+    const bool fileChanged = entry->item == nullptr
+                             || fileStat.st_dev != entry->device
+                             || fileStat.st_ino != entry->inode
+                             || fileStat.st_size != entry->size
+                             || fileStat.st_mtim.tv_sec != entry->mtime.tv_sec
+                             || fileStat.st_mtim.tv_nsec != entry->mtime.tv_nsec;
+
+    if(fileChanged
+            && entry->dirty)
+    {
+        LOG_WARNING("ini-file " + filePath + " was changed, while the cache had unwritten "
+                    "changes. The changes of the cache will overwrite the file.");
+    }
+    else if(fileChanged)
+    {
+        if(loadEntry(entry, filePath, errorMessage) == false)
+        {
+            entry->lock.unlock();
+            return nullptr;
+        }
+    }
+
+    return entry->item;
+}
+
+/**
+ * @brief release the lock of an ini-item
+ *
+ * @param filePath path of the ini-file
+ * @param modified true, if the ini-item was changed and has to be written back to the file
+ */
+void
+IniCache::unlockItem(const std::string &filePath,
+                     const bool modified)
+{
+    IniEntry* entry = getEntry(resolveFilePath(filePath));
+    if(modified) {
+        entry->dirty = true;
+    }
+    entry->lock.unlock();
+}
+
+/**
+ * @brief write unwritten changes of an ini-file back to the file. This has to be called
+ *        before anything else than the ini-blossoms access the file.
+ *
+ * @param filePath path of the file
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if writing failed, else true
+ */
+bool
+IniCache::flush(const std::string &filePath,
+                std::string &errorMessage)
+{
+    IniEntry* entry = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        std::map<std::string, IniEntry*>::const_iterator it;
+        it = m_entries.find(resolveFilePath(filePath));
+        if(it == m_entries.end()) {
+            return true;
+        }
+        entry = it->second;
+    }
+
+    std::lock_guard<std::mutex> guard(entry->lock);
+    if(entry->dirty == false) {
+        return true;
+    }
+
+    return writeEntry(entry, filePath, errorMessage);
+}
+
+/**
+ * @brief write all unwritten changes back to their files
+ *
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if writing of at least one file failed, else true
+ */
+bool
+IniCache::flushAll(std::string &errorMessage)
+{
+    std::vector<std::string> filePaths;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        std::map<std::string, IniEntry*>::const_iterator it;
+        for(it = m_entries.begin();
+            it != m_entries.end();
+            it++)
+        {
+            filePaths.push_back(it->first);
+        }
+    }
+
+    bool result = true;
+    for(const std::string &filePath : filePaths)
+    {
+        std::string flushError = "";
+        if(flush(filePath, flushError) == false)
+        {
+            errorMessage += flushError + "\n";
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief get entry of a file and create a new one, if not exist
+ *
+ * @param filePath resolved path of the file, so different spellings of the same file share
+ *                 one entry and its lock
+ *
+ * @return pointer to the entry
+ */
+IniCache::IniEntry*
+IniCache::getEntry(const std::string &filePath)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    std::map<std::string, IniEntry*>::const_iterator it;
+    it = m_entries.find(filePath);
+    if(it != m_entries.end()) {
+        return it->second;
+    }
+
+    IniEntry* entry = new IniEntry();
+    m_entries.insert(std::make_pair(filePath, entry));
+
+    return entry;
+}
+
+/**
+ * @brief read and parse an ini-file into an entry
+ *
+ * @param entry entry to update
+ * @param filePath path of the file
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+IniCache::loadEntry(IniEntry* entry,
+                    const std::string &filePath,
+                    std::string &errorMessage)
+{
+    // get state before reading, so a change while reading results in a new parsing next time
+    struct stat fileStat;
+    if(stat(filePath.c_str(), &fileStat) != 0)
+    {
+        errorMessage = "file-path " + filePath + " doesn't exist";
+        return false;
+    }
+
+    // read file-content
+    std::string fileContent = "";
+    if(Kitsunemimi::Persistence::readFile(fileContent, filePath, errorMessage) == false) {
+        return false;
+    }
+
+    // parse file-content
+    IniItem* newItem = new IniItem();
+    if(newItem->parse(fileContent, errorMessage) == false)
+    {
+        delete newItem;
+        return false;
+    }
+
+    if(entry->item != nullptr) {
+        delete entry->item;
+    }
+
+    entry->item = newItem;
+    entry->dirty = false;
+    entry->device = fileStat.st_dev;
+    entry->inode = fileStat.st_ino;
+    entry->size = fileStat.st_size;
+    entry->mtime = fileStat.st_mtim;
+
+    return true;
+}
+
+/**
+ * @brief write an ini-item atomically back into its file
+ *
+ * @param entry entry to write
+ * @param filePath path of the file
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+IniCache::writeEntry(IniEntry* entry,
+                     const std::string &filePath,
+                     std::string &errorMessage)
+{
+    const std::string newFileContent = entry->item->toString();
+
+    uint64_t hash = 0;
+    bool changed = false;
+    if(writeFileAtomic(filePath, newFileContent, hash, changed, errorMessage) == false) {
+        return false;
+    }
+
+    // update state, so the own write is not detected as external change
+    struct stat fileStat;
+    if(stat(filePath.c_str(), &fileStat) == 0)
+    {
+        entry->device = fileStat.st_dev;
+        entry->inode = fileStat.st_ino;
+        entry->size = fileStat.st_size;
+        entry->mtime = fileStat.st_mtim;
+    }
+
+    entry->dirty = false;
+
+    return true;
+}
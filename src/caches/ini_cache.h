@@ -0,0 +1,73 @@
+/**
+ * @file        ini_cache.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef INI_CACHE_H
+#define INI_CACHE_H
+
+#include <common.h>
+#include <sys/stat.h>
+
+namespace Kitsunemimi {
+namespace Ini {
+class IniItem;
+}
+}
+
+class IniCache
+{
+public:
+    static IniCache* getInstance();
+
+    Kitsunemimi::Ini::IniItem* lockItem(const std::string &filePath, std::string &errorMessage);
+    void unlockItem(const std::string &filePath, const bool modified);
+
+    bool flush(const std::string &filePath, std::string &errorMessage);
+    bool flushAll(std::string &errorMessage);
+
+private:
+    struct IniEntry
+    {
+        std::mutex lock;
+        Kitsunemimi::Ini::IniItem* item = nullptr;
+        bool dirty = false;
+
+        // state of the file, when it was parsed or written the last time
+        dev_t device = 0;
+        ino_t inode = 0;
+        off_t size = 0;
+        struct timespec mtime;
+    };
+
+    IniCache();
+
+    static IniCache* m_instance;
+
+    std::mutex m_lock;
+    std::map<std::string, IniEntry*> m_entries;
+
+    IniEntry* getEntry(const std::string &filePath);
+    bool loadEntry(IniEntry* entry, const std::string &filePath, std::string &errorMessage);
+    bool writeEntry(IniEntry* entry, const std::string &filePath, std::string &errorMessage);
+};
+
+#endif // INI_CACHE_H
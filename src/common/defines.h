@@ -25,6 +25,9 @@
 
 #include <common/includes.h>
 
+// prefix of the line, which contains the result of a subtree, which was executed by an agent
+#define AGENT_RESULT_PREFIX "SAKURA_AGENT_RESULT: "
+
 #define ASCII_LOGO "" \
 "                                                                        \n" \
 "                               ,o'    ,l'                               \n" \
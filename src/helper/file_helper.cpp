@@ -0,0 +1,1198 @@
+/**
+ * @file        file_helper.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "file_helper.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <regex>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+/**
+ * @brief update a fnv1a-hash with new data, so a hash can be calculated chunk by chunk
+ *
+ * @param hash reference to the hash, which has to be initialized with FNV_HASH_OFFSET
+ * @param data pointer to the new data
+ * @param size number of bytes of the new data
+ */
+void
+updateHash(uint64_t &hash,
+           const char* data,
+           const uint64_t size)
+{
+    for(uint64_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+}
+
+/**
+ * @brief calculate the hash of a file chunk by chunk, without loading the complete file
+ *
+ * @param filePath path of the file
+ * @param hash reference for the resulting hash
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if file couldn't be read, else true
+ */
+bool
+hashFile(const std::string &filePath,
+         uint64_t &hash,
+         std::string &errorMessage)
+{
+    const int fd = open(filePath.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        errorMessage = "couldn't open file " + filePath;
+        return false;
+    }
+
+    hash = FNV_HASH_OFFSET;
+    std::vector<char> buffer(FILE_HELPER_CHUNK_SIZE);
+    while(true)
+    {
+        const ssize_t readSize = read(fd, &buffer[0], buffer.size());
+        if(readSize < 0)
+        {
+            close(fd);
+            errorMessage = "couldn't read file " + filePath;
+            return false;
+        }
+        if(readSize == 0) {
+            break;
+        }
+
+        updateHash(hash, &buffer[0], static_cast<uint64_t>(readSize));
+    }
+
+    close(fd);
+    return true;
+}
+
+/**
+ * @brief create unique path for a temporary file in the same directory like the given file,
+ *        so it can be renamed into the final path afterwards
+ *
+ * @param filePath path of the final file
+ *
+ * @return path for a temporary file
+ */
+const std::string
+createTempPath(const std::string &filePath)
+{
+    static std::atomic<uint64_t> tempCounter(0);
+    return filePath
+           + ".sakura_tmp_"
+           + std::to_string(getpid())
+           + "_"
+           + std::to_string(tempCounter.fetch_add(1));
+}
+
+/**
+ * @brief resolve all symlinks of a path, so the target of a symlink is replaced and not the
+ *        symlink itself
+ *
+ * @param filePath path of the file
+ *
+ * @return resolved path, or the original path, if the file doesn't exist
+ */
+const std::string
+resolveFilePath(const std::string &filePath)
+{
+    char* resolvedPath = realpath(filePath.c_str(), nullptr);
+    if(resolvedPath == nullptr) {
+        return filePath;
+    }
+
+    const std::string result(resolvedPath);
+    free(resolvedPath);
+
+    return result;
+}
+
+/**
+ * @brief give a temporary file the owner and permissions of the file, which it replaces. The
+ *        permissions are set explicitly, because the mode of open is masked by the umask.
+ *        The owner can only be changed by root, so other users can still replace files, which
+ *        they are allowed to write, but don't own.
+ *
+ * @param fd file-descriptor of the temporary file
+ * @param fileStat stat of the file, which is replaced
+ * @param filePath path of the file, which is replaced
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if owner or permissions couldn't be set, else true
+ */
+bool
+copyFileAttributes(const int fd,
+                   const struct stat &fileStat,
+                   const std::string &filePath,
+                   std::string &errorMessage)
+{
+    struct stat tempStat;
+    const bool sameOwner = fstat(fd, &tempStat) == 0
+                           && tempStat.st_uid == fileStat.st_uid
+                           && tempStat.st_gid == fileStat.st_gid;
+
+    if(sameOwner == false
+            && geteuid() == 0
+            && fchown(fd, fileStat.st_uid, fileStat.st_gid) != 0)
+    {
+        errorMessage = "couldn't keep owner of file " + filePath + ": " + strerror(errno);
+        return false;
+    }
+
+    if(fchmod(fd, fileStat.st_mode & 07777) != 0)
+    {
+        errorMessage = "couldn't keep permissions of file " + filePath + ": " + strerror(errno);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief move a completely written and synced temporary file into its final path and sync the
+ *        directory afterwards, so the new file still exist after a crash
+ *
+ * @param tempPath path of the temporary file
+ * @param filePath final path of the file
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if renaming failed, else true
+ */
+bool
+commitTempFile(const std::string &tempPath,
+               const std::string &filePath,
+               std::string &errorMessage)
+{
+    if(rename(tempPath.c_str(), filePath.c_str()) != 0)
+    {
+        unlink(tempPath.c_str());
+        errorMessage = "couldn't rename temporary file to " + filePath;
+        return false;
+    }
+
+    std::string dirPath = ".";
+    const size_t slashPos = filePath.rfind('/');
+    if(slashPos == 0) {
+        dirPath = "/";
+    } else if(slashPos != std::string::npos) {
+        dirPath = filePath.substr(0, slashPos);
+    }
+
+    const int dirFd = open(dirPath.c_str(), O_RDONLY | O_DIRECTORY);
+    if(dirFd >= 0)
+    {
+        fsync(dirFd);
+        close(dirFd);
+    }
+
+    return true;
+}
+
+/**
+ * @brief compare the content of a file chunk by chunk with a string, without loading the
+ *        complete file
+ *
+ * @param filePath path of the file
+ * @param content content to compare with
+ *
+ * @return true, if the file has exactly the same content, else false
+ */
+bool
+hasFileContent(const std::string &filePath,
+               const std::string &content)
+{
+    const int fd = open(filePath.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+
+    std::vector<char> buffer(FILE_HELPER_CHUNK_SIZE);
+    uint64_t pos = 0;
+    bool equal = true;
+    while(equal)
+    {
+        const ssize_t readSize = read(fd, &buffer[0], buffer.size());
+        if(readSize < 0
+                && errno == EINTR)
+        {
+            continue;
+        }
+        if(readSize < 0)
+        {
+            equal = false;
+            break;
+        }
+        if(readSize == 0) {
+            break;
+        }
+
+        const uint64_t size = static_cast<uint64_t>(readSize);
+        equal = pos + size <= content.size()
+                && memcmp(&buffer[0], content.c_str() + pos, size) == 0;
+        pos += size;
+    }
+
+    close(fd);
+
+    return equal && pos == content.size();
+}
+
+/**
+ * @brief write content chunk by chunk into a temporary file and rename it to the final path
+ *        afterwards. The existing file is compared with the content before, so the file is
+ *        only written, if its content is different. Symlinks are resolved and owner and
+ *        permissions of an existing file are kept.
+ *
+ * @param filePath path of the file
+ * @param content new content of the file
+ * @param hash reference for the hash of the new content
+ * @param changed reference, which is set to false, if the existing file has already the same
+ *                content, else true
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+writeFileAtomic(const std::string &filePath,
+                const std::string &content,
+                uint64_t &hash,
+                bool &changed,
+                std::string &errorMessage)
+{
+    const std::string targetPath = resolveFilePath(filePath);
+
+    hash = FNV_HASH_OFFSET;
+    updateHash(hash, content.c_str(), content.size());
+
+    // compare with the existing file, before anything is written
+    struct stat fileStat;
+    const bool exist = stat(targetPath.c_str(), &fileStat) == 0;
+    if(exist
+            && static_cast<uint64_t>(fileStat.st_size) == content.size()
+            && hasFileContent(targetPath, content))
+    {
+        changed = false;
+        return true;
+    }
+
+    const std::string tempPath = createTempPath(targetPath);
+    const int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+        errorMessage = "couldn't create temporary file " + tempPath;
+        return false;
+    }
+
+    // keep owner and permissions of an already existing file
+    if(exist
+            && copyFileAttributes(fd, fileStat, targetPath, errorMessage) == false)
+    {
+        close(fd);
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    // write chunk by chunk
+    uint64_t pos = 0;
+    while(pos < content.size())
+    {
+        const uint64_t chunkSize = std::min(static_cast<uint64_t>(FILE_HELPER_CHUNK_SIZE),
+                                            content.size() - pos);
+        const ssize_t writeSize = write(fd, content.c_str() + pos, chunkSize);
+        if(writeSize <= 0)
+        {
+            close(fd);
+            unlink(tempPath.c_str());
+            errorMessage = "couldn't write temporary file " + tempPath;
+            return false;
+        }
+
+        pos += static_cast<uint64_t>(writeSize);
+    }
+
+    // sync the content before the rename, so a crash can not leave an empty file behind
+    if(fsync(fd) != 0)
+    {
+        close(fd);
+        unlink(tempPath.c_str());
+        errorMessage = "couldn't sync temporary file " + tempPath;
+        return false;
+    }
+    close(fd);
+
+    if(commitTempFile(tempPath, targetPath, errorMessage) == false) {
+        return false;
+    }
+
+    changed = true;
+    return true;
+}
+
+/**
+ * @brief append data to an output-buffer and write the buffer into a file, when it becomes
+ *        larger than one chunk
+ *
+ * @param fd file-descriptor of the target-file
+ * @param outputBuffer buffer for the data to write
+ * @param data pointer to the new data
+ * @param size number of bytes of the new data
+ * @param forceWrite true to write the buffer independent of its size
+ *
+ * @return false, if writing failed, else true
+ */
+bool
+writeBuffered(const int fd,
+              std::string &outputBuffer,
+              const char* data,
+              const uint64_t size,
+              const bool forceWrite = false)
+{
+    outputBuffer.append(data, size);
+    if(outputBuffer.size() < FILE_HELPER_CHUNK_SIZE
+            && forceWrite == false)
+    {
+        return true;
+    }
+
+    uint64_t pos = 0;
+    while(pos < outputBuffer.size())
+    {
+        const ssize_t writeSize = write(fd, outputBuffer.c_str() + pos, outputBuffer.size() - pos);
+        if(writeSize <= 0) {
+            return false;
+        }
+        pos += static_cast<uint64_t>(writeSize);
+    }
+    outputBuffer.clear();
+
+    return true;
+}
+
+/**
+ * @brief open a file for streaming and a temporary file with the same permissions, which
+ *        replaces the file at the end
+ *
+ * @param filePath path of the file
+ * @param tempPath path of the temporary file
+ * @param inputFd reference for the file-descriptor of the file
+ * @param outputFd reference for the file-descriptor of the temporary file
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if one of the files couldn't be opened, else true
+ */
+bool
+openStreamFiles(const std::string &filePath,
+                const std::string &tempPath,
+                int &inputFd,
+                int &outputFd,
+                std::string &errorMessage)
+{
+    struct stat fileStat;
+    if(stat(filePath.c_str(), &fileStat) != 0)
+    {
+        errorMessage = "file " + filePath + " doesn't exist";
+        return false;
+    }
+
+    inputFd = open(filePath.c_str(), O_RDONLY);
+    if(inputFd < 0)
+    {
+        errorMessage = "couldn't open file " + filePath;
+        return false;
+    }
+
+    outputFd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, fileStat.st_mode & 07777);
+    if(outputFd < 0)
+    {
+        close(inputFd);
+        errorMessage = "couldn't create temporary file " + tempPath;
+        return false;
+    }
+
+    if(copyFileAttributes(outputFd, fileStat, filePath, errorMessage) == false)
+    {
+        close(inputFd);
+        close(outputFd);
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief close the files of a streaming replacement and move the temporary file into the
+ *        final path, if something was replaced
+ *
+ * @param filePath path of the file
+ * @param tempPath path of the temporary file
+ * @param inputFd file-descriptor of the file
+ * @param outputFd file-descriptor of the temporary file
+ * @param success true, if the temporary file was completely written
+ * @param matchCount number of replacements
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if streaming or renaming failed, else true
+ */
+bool
+finishStreamFiles(const std::string &filePath,
+                  const std::string &tempPath,
+                  const int inputFd,
+                  const int outputFd,
+                  const bool success,
+                  const uint64_t matchCount,
+                  std::string &errorMessage)
+{
+    close(inputFd);
+
+    // keep the original file untouched, if nothing was replaced
+    if(success == false
+            || matchCount == 0)
+    {
+        close(outputFd);
+        unlink(tempPath.c_str());
+        return success;
+    }
+
+    if(fsync(outputFd) != 0)
+    {
+        close(outputFd);
+        unlink(tempPath.c_str());
+        errorMessage = "couldn't sync temporary file " + tempPath;
+        return false;
+    }
+    close(outputFd);
+
+    return commitTempFile(tempPath, filePath, errorMessage);
+}
+
+/**
+ * @brief replace all occurrences of a string within a file chunk by chunk, so the memory-usage
+ *        is independent of the file-size. Candidates are found by searching the first byte of
+ *        the old text with memchr and verified with memcmp afterwards. The result is written
+ *        into a temporary file, which replaces the original file at the end.
+ *
+ * @param filePath path of the file
+ * @param oldText text to replace
+ * @param newText new text
+ * @param matchCount reference for the number of replacements
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+replaceInFile(const std::string &filePath,
+              const std::string &oldText,
+              const std::string &newText,
+              uint64_t &matchCount,
+              std::string &errorMessage)
+{
+    matchCount = 0;
+    if(oldText.size() == 0)
+    {
+        errorMessage = "text to replace is empty";
+        return false;
+    }
+
+    // replace the target of a symlink instead of the symlink itself
+    const std::string targetPath = resolveFilePath(filePath);
+    const std::string tempPath = createTempPath(targetPath);
+    int inputFd = -1;
+    int outputFd = -1;
+    if(openStreamFiles(targetPath, tempPath, inputFd, outputFd, errorMessage) == false) {
+        return false;
+    }
+
+    const uint64_t patternSize = oldText.size();
+    const char firstByte = oldText.at(0);
+
+    // the buffer keeps the last bytes of the previous chunk, to find matches across the border
+    std::vector<char> buffer(FILE_HELPER_CHUNK_SIZE + patternSize);
+    std::string outputBuffer;
+    uint64_t carrySize = 0;
+    bool success = true;
+
+    while(success)
+    {
+        const ssize_t readSize = read(inputFd, &buffer[carrySize], FILE_HELPER_CHUNK_SIZE);
+        if(readSize < 0)
+        {
+            errorMessage = "couldn't read file " + filePath;
+            success = false;
+            break;
+        }
+
+        const uint64_t dataSize = carrySize + static_cast<uint64_t>(readSize);
+        const char* data = &buffer[0];
+        uint64_t writtenPos = 0;
+        uint64_t searchPos = 0;
+
+        // search all matches, which fit completely into the buffer
+        while(searchPos + patternSize <= dataSize)
+        {
+            const void* hit = memchr(data + searchPos,
+                                     firstByte,
+                                     dataSize - patternSize + 1 - searchPos);
+            if(hit == nullptr) {
+                break;
+            }
+
+            const uint64_t hitPos = static_cast<uint64_t>(static_cast<const char*>(hit) - data);
+            if(memcmp(data + hitPos, oldText.c_str(), patternSize) != 0)
+            {
+                searchPos = hitPos + 1;
+                continue;
+            }
+
+            success = writeBuffered(outputFd, outputBuffer, data + writtenPos, hitPos - writtenPos)
+                      && writeBuffered(outputFd, outputBuffer, newText.c_str(), newText.size());
+            matchCount++;
+            writtenPos = hitPos + patternSize;
+            searchPos = writtenPos;
+        }
+
+        // write the rest at the end of the file
+        if(readSize == 0)
+        {
+            success = success
+                      && writeBuffered(outputFd, outputBuffer, data + writtenPos,
+                                       dataSize - writtenPos, true);
+            break;
+        }
+
+        // keep the possible beginning of a match for the next chunk
+        const uint64_t flushEnd = std::max(writtenPos, dataSize - std::min(dataSize,
+                                                                           patternSize - 1));
+        success = success
+                  && writeBuffered(outputFd, outputBuffer, data + writtenPos,
+                                   flushEnd - writtenPos);
+        carrySize = dataSize - flushEnd;
+        memmove(&buffer[0], &buffer[flushEnd], carrySize);
+    }
+
+    if(success == false
+            && errorMessage == "")
+    {
+        errorMessage = "couldn't write temporary file " + tempPath;
+    }
+
+    return finishStreamFiles(targetPath, tempPath, inputFd, outputFd,
+                             success, matchCount, errorMessage);
+}
+
+/**
+ * @brief replace all matches of a regular expression within a file line by line, so the
+ *        memory-usage depends only on the length of the longest line
+ *
+ * @param filePath path of the file
+ * @param pattern regular expression to search
+ * @param newText replacement, which can contain references to groups like $1
+ * @param matchCount reference for the number of replacements
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+replaceRegexInFile(const std::string &filePath,
+                   const std::string &pattern,
+                   const std::string &newText,
+                   uint64_t &matchCount,
+                   std::string &errorMessage)
+{
+    matchCount = 0;
+
+    // compile regex only once for the whole file
+    std::regex regex;
+    try {
+        regex = std::regex(pattern, std::regex::ECMAScript | std::regex::optimize);
+    } catch(const std::regex_error &e) {
+        errorMessage = "invalid regular expression " + pattern + ": " + e.what();
+        return false;
+    }
+
+    // replace the target of a symlink instead of the symlink itself
+    const std::string targetPath = resolveFilePath(filePath);
+    const std::string tempPath = createTempPath(targetPath);
+    int inputFd = -1;
+    int outputFd = -1;
+    if(openStreamFiles(targetPath, tempPath, inputFd, outputFd, errorMessage) == false) {
+        return false;
+    }
+
+    std::vector<char> buffer(FILE_HELPER_CHUNK_SIZE);
+    std::string outputBuffer;
+    std::string line;
+    bool success = true;
+
+    while(success)
+    {
+        const ssize_t readSize = read(inputFd, &buffer[0], buffer.size());
+        if(readSize < 0)
+        {
+            errorMessage = "couldn't read file " + filePath;
+            success = false;
+            break;
+        }
+
+        const bool endOfFile = readSize == 0;
+        const char* data = &buffer[0];
+        const char* end = data + readSize;
+
+        while(success)
+        {
+            // split at line-break or take the last line without line-break at the end of the file
+            const char* lineEnd = static_cast<const char*>(memchr(data, '\n', end - data));
+            if(lineEnd == nullptr)
+            {
+                line.append(data, end - data);
+                if(endOfFile == false
+                        || line.size() == 0)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                line.append(data, lineEnd - data);
+            }
+
+            const uint64_t lineMatches = static_cast<uint64_t>(
+                        std::distance(std::sregex_iterator(line.begin(), line.end(), regex),
+                                      std::sregex_iterator()));
+            if(lineMatches > 0)
+            {
+                line = std::regex_replace(line, regex, newText);
+                matchCount += lineMatches;
+            }
+
+            if(lineEnd != nullptr) {
+                line.push_back('\n');
+            }
+            success = writeBuffered(outputFd, outputBuffer, line.c_str(), line.size());
+            line.clear();
+
+            if(lineEnd == nullptr) {
+                break;
+            }
+            data = lineEnd + 1;
+        }
+
+        if(endOfFile)
+        {
+            success = success && writeBuffered(outputFd, outputBuffer, "", 0, true);
+            break;
+        }
+    }
+
+    if(success == false
+            && errorMessage == "")
+    {
+        errorMessage = "couldn't write temporary file " + tempPath;
+    }
+
+    return finishStreamFiles(targetPath, tempPath, inputFd, outputFd,
+                             success, matchCount, errorMessage);
+}
+
+/**
+ * @brief read a file and split it into lines, where the line-breaks are searched with memchr
+ *
+ * @param filePath path of the file
+ * @param lines reference for the resulting lines without line-breaks
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if the file couldn't be read, else true
+ */
+bool
+readLines(const std::string &filePath,
+          std::vector<std::string> &lines,
+          std::string &errorMessage)
+{
+    const int fd = open(filePath.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        errorMessage = "couldn't open file " + filePath;
+        return false;
+    }
+
+    std::vector<char> buffer(FILE_HELPER_CHUNK_SIZE);
+    std::string line;
+    while(true)
+    {
+        const ssize_t readSize = read(fd, &buffer[0], buffer.size());
+        if(readSize < 0)
+        {
+            close(fd);
+            errorMessage = "couldn't read file " + filePath;
+            return false;
+        }
+        if(readSize == 0) {
+            break;
+        }
+
+        const char* data = &buffer[0];
+        const char* end = data + readSize;
+        while(true)
+        {
+            const char* lineEnd = static_cast<const char*>(memchr(data, '\n', end - data));
+            if(lineEnd == nullptr)
+            {
+                line.append(data, end - data);
+                break;
+            }
+
+            line.append(data, lineEnd - data);
+            lines.push_back(line);
+            line.clear();
+            data = lineEnd + 1;
+        }
+    }
+    close(fd);
+
+    // last line without line-break
+    if(line.size() > 0) {
+        lines.push_back(line);
+    }
+
+    return true;
+}
+
+/**
+ * @brief make sure, that lines exist in a file with only one pass over the file. Lines without
+ *        regex are appended, if not already in the file. Lines with regex replace the first
+ *        line, which matches the regex, or are appended, if no line matches. The file is only
+ *        written, if at least one line was added or replaced.
+ *
+ * @param filePath path of the file, which is created, if not exist
+ * @param requests list of lines with their optional regex
+ * @param addedLines reference for the number of appended lines
+ * @param replacedLines reference for the number of replaced lines
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+ensureLinesInFile(const std::string &filePath,
+                  const std::vector<EnsureLineRequest> &requests,
+                  uint64_t &addedLines,
+                  uint64_t &replacedLines,
+                  std::string &errorMessage)
+{
+    addedLines = 0;
+    replacedLines = 0;
+
+    std::vector<std::string> lines;
+    struct stat fileStat;
+    if(stat(filePath.c_str(), &fileStat) == 0
+            && readLines(filePath, lines, errorMessage) == false)
+    {
+        return false;
+    }
+
+    // index all existing lines for lookups in constant time, where each line is counted,
+    // because the same line can exist multiple times and only one of them can be replaced
+    std::unordered_map<std::string, uint64_t> existingLines;
+    for(const std::string &line : lines) {
+        existingLines[line]++;
+    }
+
+    for(const EnsureLineRequest &request : requests)
+    {
+        if(request.regex != "")
+        {
+            std::regex regex;
+            try {
+                regex = std::regex(request.regex, std::regex::ECMAScript | std::regex::optimize);
+            } catch(const std::regex_error &e) {
+                errorMessage = "invalid regular expression " + request.regex + ": " + e.what();
+                return false;
+            }
+
+            // replace first matching line
+            bool found = false;
+            for(std::string &line : lines)
+            {
+                if(std::regex_search(line, regex) == false) {
+                    continue;
+                }
+
+                found = true;
+                if(line != request.line)
+                {
+                    std::unordered_map<std::string, uint64_t>::iterator countIt;
+                    countIt = existingLines.find(line);
+                    if(--countIt->second == 0) {
+                        existingLines.erase(countIt);
+                    }
+
+                    line = request.line;
+                    existingLines[request.line]++;
+                    replacedLines++;
+                }
+                break;
+            }
+
+            if(found) {
+                continue;
+            }
+        }
+
+        if(existingLines.find(request.line) == existingLines.end())
+        {
+            lines.push_back(request.line);
+            existingLines[request.line]++;
+            addedLines++;
+        }
+    }
+
+    if(addedLines == 0
+            && replacedLines == 0)
+    {
+        return true;
+    }
+
+    // write updated file
+    std::string content;
+    for(const std::string &line : lines)
+    {
+        content.append(line);
+        content.push_back('\n');
+    }
+
+    uint64_t hash = 0;
+    bool changed = false;
+    return writeFileAtomic(filePath, content, hash, changed, errorMessage);
+}
+
+/**
+ * @brief search forward the end of the first lines of a range
+ *
+ * @param begin begin of the range
+ * @param end end of the range
+ * @param numberOfLines number of lines to search
+ *
+ * @return position behind the line-break of the last requested line, or end of the range
+ */
+const char*
+findHeadEnd(const char* begin,
+            const char* end,
+            const uint64_t numberOfLines)
+{
+    const char* pos = begin;
+    for(uint64_t i = 0; i < numberOfLines && pos < end; i++)
+    {
+        const void* lineEnd = memchr(pos, '\n', static_cast<size_t>(end - pos));
+        if(lineEnd == nullptr) {
+            return end;
+        }
+        pos = static_cast<const char*>(lineEnd) + 1;
+    }
+
+    return pos;
+}
+
+/**
+ * @brief search backward the beginning of the last lines of a range, where a line-break at
+ *        the end doesn't start a new line
+ *
+ * @param begin begin of the range
+ * @param end end of the range
+ * @param numberOfLines number of lines to search
+ *
+ * @return beginning of the first requested line, or begin of the range
+ */
+const char*
+findTailBegin(const char* begin,
+              const char* end,
+              const uint64_t numberOfLines)
+{
+    const char* pos = end;
+    if(pos > begin
+            && *(pos - 1) == '\n')
+    {
+        pos--;
+    }
+
+    for(uint64_t i = 0; i < numberOfLines && pos > begin; i++)
+    {
+        const void* lineBreak = memrchr(begin, '\n', static_cast<size_t>(pos - begin));
+        if(lineBreak == nullptr) {
+            return begin;
+        }
+
+        // the line-break of the last requested line marks the beginning
+        if(i + 1 == numberOfLines) {
+            return static_cast<const char*>(lineBreak) + 1;
+        }
+        pos = static_cast<const char*>(lineBreak);
+    }
+
+    return pos;
+}
+
+/**
+ * @brief read a block of a file at a specific position
+ *
+ * @param fd file-descriptor of the file
+ * @param buffer buffer to write the read data into
+ * @param size number of bytes to read
+ * @param offset position within the file
+ *
+ * @return number of read bytes, which is smaller than size, if the end of the file was
+ *         reached, or -1, if reading failed
+ */
+ssize_t
+preadComplete(const int fd,
+              char* buffer,
+              const size_t size,
+              const uint64_t offset)
+{
+    size_t pos = 0;
+    while(pos < size)
+    {
+        const ssize_t ret = pread(fd,
+                                  buffer + pos,
+                                  size - pos,
+                                  static_cast<off_t>(offset + pos));
+        if(ret < 0
+                && errno == EINTR)
+        {
+            continue;
+        }
+        if(ret < 0) {
+            return -1;
+        }
+        if(ret == 0) {
+            break;
+        }
+
+        pos += static_cast<size_t>(ret);
+    }
+
+    return static_cast<ssize_t>(pos);
+}
+
+/**
+ * @brief read a part of a file, which is not a regular file or has no size, like the files of
+ *        procfs and sysfs. These can only be read completely from the beginning.
+ *
+ * @param fd file-descriptor of the file
+ * @param request definition of the part to read
+ * @param content reference for the read content
+ *
+ * @return false, if reading failed, else true
+ */
+bool
+readStreamPart(const int fd,
+               const FileReadRequest &request,
+               std::string &content)
+{
+    std::string buffer;
+    std::vector<char> chunk(FILE_HELPER_CHUNK_SIZE);
+    while(true)
+    {
+        const ssize_t ret = read(fd, &chunk[0], chunk.size());
+        if(ret < 0
+                && errno == EINTR)
+        {
+            continue;
+        }
+        if(ret < 0) {
+            return false;
+        }
+        if(ret == 0) {
+            break;
+        }
+
+        buffer.append(&chunk[0], static_cast<size_t>(ret));
+    }
+
+    // range within the read data
+    const uint64_t begin = std::min(request.offset, static_cast<uint64_t>(buffer.size()));
+    uint64_t end = buffer.size();
+    if(request.length > 0) {
+        end = std::min(end, begin + request.length);
+    }
+
+    const char* rangeBegin = buffer.c_str() + begin;
+    const char* rangeEnd = buffer.c_str() + end;
+    if(request.headLines > 0) {
+        rangeEnd = findHeadEnd(rangeBegin, rangeEnd, request.headLines);
+    } else if(request.tailLines > 0) {
+        rangeBegin = findTailBegin(rangeBegin, rangeEnd, request.tailLines);
+    }
+
+    content.assign(rangeBegin, static_cast<size_t>(rangeEnd - rangeBegin));
+
+    return true;
+}
+
+/**
+ * @brief read a part of a file with pread, so only the blocks of the requested part are read
+ *        from disc. The part is defined by offset and length (length of 0 means until the end
+ *        of the file) and can be reduced further to the first or the last lines of this range.
+ *        The last lines are searched backwards block by block from the end of the range.
+ *        Files without size, like in procfs, are read completely and cut afterwards.
+ *
+ * @param filePath path of the file
+ * @param request definition of the part to read
+ * @param content reference for the read content
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+readFilePart(const std::string &filePath,
+             const FileReadRequest &request,
+             std::string &content,
+             std::string &errorMessage)
+{
+    content.clear();
+
+    const int fd = open(filePath.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        errorMessage = "couldn't open file " + filePath;
+        return false;
+    }
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0)
+    {
+        close(fd);
+        errorMessage = "couldn't get size of file " + filePath;
+        return false;
+    }
+
+    // files of procfs and sysfs have no size, so their real end is only known after reading
+    if(S_ISREG(fileStat.st_mode) == false
+            || fileStat.st_size == 0)
+    {
+        const bool result = readStreamPart(fd, request, content);
+        close(fd);
+        if(result == false) {
+            errorMessage = "couldn't read file " + filePath;
+        }
+        return result;
+    }
+
+    // range within the file
+    const uint64_t fileSize = static_cast<uint64_t>(fileStat.st_size);
+    const uint64_t begin = std::min(request.offset, fileSize);
+    uint64_t end = fileSize;
+    if(request.length > 0) {
+        end = std::min(end, begin + request.length);
+    }
+
+    std::vector<char> chunk(FILE_HELPER_CHUNK_SIZE);
+    bool result = true;
+
+    if(request.tailLines > 0)
+    {
+        // read backward block by block, until enough line-breaks were found. The line-break
+        // at the end of the range doesn't count, because it doesn't start a new line.
+        uint64_t pos = end;
+        uint64_t lineBreaks = 0;
+        while(pos > begin
+              && lineBreaks <= request.tailLines)
+        {
+            const uint64_t readSize = std::min(static_cast<uint64_t>(chunk.size()), pos - begin);
+            pos -= readSize;
+            const ssize_t ret = preadComplete(fd, &chunk[0], readSize, pos);
+            if(ret != static_cast<ssize_t>(readSize))
+            {
+                errorMessage = "couldn't read file " + filePath + ", or it was changed while "
+                               "reading";
+                result = false;
+                break;
+            }
+
+            content.insert(0, &chunk[0], readSize);
+            lineBreaks += static_cast<uint64_t>(std::count(chunk.begin(),
+                                                           chunk.begin() + ret,
+                                                           '\n'));
+        }
+
+        if(result)
+        {
+            const char* rangeEnd = content.c_str() + content.size();
+            const char* tailBegin = findTailBegin(content.c_str(), rangeEnd, request.tailLines);
+            content.erase(0, static_cast<size_t>(tailBegin - content.c_str()));
+        }
+    }
+    else
+    {
+        // read forward block by block, where a file, which was shrinked while reading, only
+        // ends the content earlier
+        uint64_t pos = begin;
+        uint64_t lineBreaks = 0;
+        while(pos < end
+              && (request.headLines == 0
+                  || lineBreaks < request.headLines))
+        {
+            const uint64_t readSize = std::min(static_cast<uint64_t>(chunk.size()), end - pos);
+            const ssize_t ret = preadComplete(fd, &chunk[0], readSize, pos);
+            if(ret < 0)
+            {
+                errorMessage = "couldn't read file " + filePath;
+                result = false;
+                break;
+            }
+            if(ret == 0) {
+                break;
+            }
+
+            content.append(&chunk[0], static_cast<size_t>(ret));
+            lineBreaks += static_cast<uint64_t>(std::count(chunk.begin(),
+                                                           chunk.begin() + ret,
+                                                           '\n'));
+            pos += static_cast<uint64_t>(ret);
+        }
+
+        if(result
+                && request.headLines > 0)
+        {
+            const char* rangeEnd = content.c_str() + content.size();
+            const char* headEnd = findHeadEnd(content.c_str(), rangeEnd, request.headLines);
+            content.resize(static_cast<size_t>(headEnd - content.c_str()));
+        }
+    }
+
+    close(fd);
+
+    if(result == false) {
+        content.clear();
+    }
+
+    return result;
+}
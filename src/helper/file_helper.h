@@ -0,0 +1,84 @@
+/**
+ * @file        file_helper.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef FILE_HELPER_H
+#define FILE_HELPER_H
+
+#include <common.h>
+
+#define FILE_HELPER_CHUNK_SIZE (1024 * 1024)
+#define FNV_HASH_OFFSET 14695981039346656037ULL
+
+struct FileReadRequest
+{
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    uint64_t headLines = 0;
+    uint64_t tailLines = 0;
+};
+
+struct EnsureLineRequest
+{
+    std::string line = "";
+    std::string regex = "";
+};
+
+void updateHash(uint64_t &hash, const char* data, const uint64_t size);
+
+bool hashFile(const std::string &filePath,
+              uint64_t &hash,
+              std::string &errorMessage);
+
+const std::string createTempPath(const std::string &filePath);
+const std::string resolveFilePath(const std::string &filePath);
+
+bool writeFileAtomic(const std::string &filePath,
+                     const std::string &content,
+                     uint64_t &hash,
+                     bool &changed,
+                     std::string &errorMessage);
+
+bool replaceInFile(const std::string &filePath,
+                   const std::string &oldText,
+                   const std::string &newText,
+                   uint64_t &matchCount,
+                   std::string &errorMessage);
+
+bool replaceRegexInFile(const std::string &filePath,
+                        const std::string &pattern,
+                        const std::string &newText,
+                        uint64_t &matchCount,
+                        std::string &errorMessage);
+
+bool ensureLinesInFile(const std::string &filePath,
+                       const std::vector<EnsureLineRequest> &requests,
+                       uint64_t &addedLines,
+                       uint64_t &replacedLines,
+                       std::string &errorMessage);
+
+bool readFilePart(const std::string &filePath,
+                  const FileReadRequest &request,
+                  std::string &content,
+                  std::string &errorMessage);
+
+#endif // FILE_HELPER_H
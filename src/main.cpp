@@ -23,10 +23,16 @@
 #include <common.h>
 #include <args.h>
 #include <sakura_root.h>
+#include <agent/agent_messages.h>
+#include <processing/duration_history.h>
+#include <processing/fail_fast.h>
+#include <processing/resource_limits.h>
+#include <processing/thread_pool.h>
 
 #include <libKitsunemimiCommon/common_methods/string_methods.h>
 #include <libKitsunemimiPersistence/logger/logger.h>
 #include <libKitsunemimiPersistence/files/file_methods.h>
+#include <libKitsunemimiPersistence/files/text_file.h>
 #include <libKitsunemimiArgs/arg_parser.h>
 
 const std::string version = "0.4.1";
@@ -71,7 +77,101 @@ int main(int argc, char *argv[])
         }
     }
 
+    // size of the global thread-pool, which limits also the number of parallel blossoms
+    uint32_t maxThreads = ThreadPool::getDefaultNumberOfThreads();
+    if(argParser.wasSet("max-threads"))
+    {
+        const long maxThreadsValue = argParser.getIntValues("max-threads")[0];
+        if(maxThreadsValue < 1)
+        {
+            std::cout << "max-threads must be at least 1" << std::endl;
+            return 1;
+        }
+        maxThreads = static_cast<uint32_t>(maxThreadsValue);
+    }
+    ThreadPool::initInstance(maxThreads);
+
+    // resource-limits to override the defaults
+    if(argParser.wasSet("resource-limit"))
+    {
+        const std::vector<std::string> limits = argParser.getStringValues("resource-limit");
+        for(const std::string &limit : limits)
+        {
+            std::string errorMessage = "";
+            if(ResourceLimits::getInstance()->setLimit(limit, errorMessage) == false)
+            {
+                std::cout << errorMessage << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    // cancel all branches on the first error, which is the default for ci-runs
+    bool failFast = getenv("CI") != nullptr;
+    if(argParser.wasSet("fail-fast")) {
+        failFast = true;
+    }
+    if(argParser.wasSet("no-fail-fast")) {
+        failFast = false;
+    }
+    FailFast::getInstance()->setEnabled(failFast);
+
+    // durations of previous runs to start the longest blossoms first
+    std::string historyPath = "";
+    if(argParser.wasSet("duration-history")) {
+        historyPath = argParser.getStringValues("duration-history")[0];
+    } else if(getenv("HOME") != nullptr) {
+        historyPath = std::string(getenv("HOME")) + "/.sakura_tree/durations";
+    }
+    if(historyPath != ""
+            && argParser.wasSet("no-duration-history") == false)
+    {
+        std::string errorMessage = "";
+        if(DurationHistory::getInstance()->load(historyPath, errorMessage) == false)
+        {
+            std::cout << "failed to read duration-history: " << errorMessage << std::endl;
+            return 1;
+        }
+    }
+
+    // shared token of agents and controllers, where the environment-variable is preferred,
+    // because command-line-arguments are visible for all users
+    if(getenv("SAKURA_AGENT_TOKEN") != nullptr)
+    {
+        setAgentToken(std::string(getenv("SAKURA_AGENT_TOKEN")));
+    }
+    else if(argParser.wasSet("agent-token-file"))
+    {
+        const std::string tokenPath = argParser.getStringValues("agent-token-file")[0];
+        std::string token = "";
+        std::string errorMessage = "";
+        if(Kitsunemimi::Persistence::readFile(token, tokenPath, errorMessage) == false)
+        {
+            std::cout << "failed to read agent-token: " << errorMessage << std::endl;
+            return 1;
+        }
+        Kitsunemimi::trim(token);
+        setAgentToken(token);
+    }
+
+    // persistent agent-mode, which doesn't need an input-path
+    if(argParser.wasSet("agent-listen"))
+    {
+        SakuraRoot* root = new SakuraRoot(std::string(argv[0]));
+        const std::string address = argParser.getStringValues("agent-listen")[0];
+        if(root->startAgentServer(address)) {
+            return 0;
+        }
+
+        return 1;
+    }
+
     // input-path
+    if(argParser.wasSet("input-path") == false)
+    {
+        std::cout << "input-path is required" << std::endl;
+        return 1;
+    }
     bfs::path inputPath = argParser.getStringValues("input-path")[0];
     std::cout << "input-path: " << inputPath << std::endl;
     if(inputPath.is_relative()) {
@@ -81,9 +181,21 @@ int main(int argc, char *argv[])
 
     SakuraRoot* root = new SakuraRoot(std::string(argv[0]));
 
+    // agent-mode, when called by the subtree-blossom of the ssh-group
+    if(argParser.wasSet("agent-values"))
+    {
+        const std::string valuesPath = argParser.getStringValues("agent-values")[0];
+        if(root->startAgentProcess(inputPath.string(), valuesPath)) {
+            return 0;
+        }
+
+        return 1;
+    }
+
     if(root->startProcess(inputPath.string(),
                           itemInputValues,
-                          argParser.wasSet("dry-run")))
+                          argParser.wasSet("dry-run"),
+                          argParser.wasSet("auto-parallel")))
     {
         return 0;
     }
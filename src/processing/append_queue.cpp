@@ -0,0 +1,205 @@
+/**
+ * @file        append_queue.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "append_queue.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+
+AppendQueue* AppendQueue::m_instance = nullptr;
+
+/**
+ * @brief constructor
+ */
+AppendQueue::AppendQueue() {}
+
+/**
+ * @brief get instance of the append-queue, which is shared by all threads
+ *
+ * @return pointer to the queue
+ */
+AppendQueue*
+AppendQueue::getInstance()
+{
+    static std::mutex instanceLock;
+    std::lock_guard<std::mutex> guard(instanceLock);
+
+    if(m_instance == nullptr) {
+        m_instance = new AppendQueue();
+    }
+
+    return m_instance;
+}
+
+/**
+ * @brief append text to a file. All appends to the same file are serialized. The thread, which
+ *        finds no other active writer for the file, takes all queued appends of other threads
+ *        and writes them together with one writev-call, while the other threads wait for the
+ *        result of their own append.
+ *
+ * @param filePath path of the file
+ * @param text text to append
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if the text of this call was written, else false
+ */
+bool
+AppendQueue::appendText(const std::string &filePath,
+                        const std::string &text,
+                        std::string &errorMessage)
+{
+    PathQueue* queue = getQueue(filePath);
+
+    AppendRequest request;
+    request.text = &text;
+
+    std::unique_lock<std::mutex> lock(queue->lock);
+    queue->pending.push_back(&request);
+
+    while(request.done == false)
+    {
+        if(queue->writerActive)
+        {
+            queue->cv.wait(lock);
+            continue;
+        }
+
+        // become the writer for all appends, which are queued at the moment
+        queue->writerActive = true;
+        std::deque<AppendRequest*> batch;
+        batch.swap(queue->pending);
+        lock.unlock();
+
+        writeBatch(filePath, batch);
+
+        lock.lock();
+        for(AppendRequest* batchRequest : batch) {
+            batchRequest->done = true;
+        }
+        queue->writerActive = false;
+        queue->cv.notify_all();
+    }
+
+    errorMessage = request.errorMessage;
+    return request.success;
+}
+
+/**
+ * @brief get queue of a file and create a new one, if not exist
+ *
+ * @param filePath path of the file
+ *
+ * @return pointer to the queue
+ */
+AppendQueue::PathQueue*
+AppendQueue::getQueue(const std::string &filePath)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    std::map<std::string, PathQueue*>::const_iterator it;
+    it = m_queues.find(filePath);
+    if(it != m_queues.end()) {
+        return it->second;
+    }
+
+    PathQueue* queue = new PathQueue();
+    m_queues.insert(std::make_pair(filePath, queue));
+
+    return queue;
+}
+
+/**
+ * @brief write all texts of a batch at the end of a file with as less syscalls as possible
+ *
+ * @param filePath path of the file
+ * @param batch list of appends
+ */
+void
+AppendQueue::writeBatch(const std::string &filePath,
+                        std::deque<AppendRequest*> &batch)
+{
+    const int fd = open(filePath.c_str(), O_WRONLY | O_APPEND);
+    if(fd < 0)
+    {
+        for(AppendRequest* request : batch) {
+            request->errorMessage = "couldn't open file " + filePath;
+        }
+        return;
+    }
+
+    std::vector<struct iovec> ioVectors;
+    for(AppendRequest* request : batch)
+    {
+        struct iovec ioVector;
+        ioVector.iov_base = const_cast<char*>(request->text->c_str());
+        ioVector.iov_len = request->text->size();
+        ioVectors.push_back(ioVector);
+    }
+
+    // write in blocks of max IOV_MAX texts and continue after partial writes
+    uint64_t pos = 0;
+    while(pos < ioVectors.size())
+    {
+        const int count = static_cast<int>(std::min(static_cast<uint64_t>(IOV_MAX),
+                                                    ioVectors.size() - pos));
+        ssize_t writeSize = writev(fd, &ioVectors[pos], count);
+        if(writeSize < 0)
+        {
+            if(errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        // mark all completely written texts as successful
+        const uint64_t startPos = pos;
+        while(pos < ioVectors.size()
+              && static_cast<uint64_t>(writeSize) >= ioVectors[pos].iov_len)
+        {
+            writeSize -= static_cast<ssize_t>(ioVectors[pos].iov_len);
+            batch[pos]->success = true;
+            pos++;
+        }
+
+        // nothing written of a non-empty text, so retrying would loop forever
+        if(pos == startPos
+                && writeSize == 0)
+        {
+            break;
+        }
+
+        if(pos < ioVectors.size())
+        {
+            ioVectors[pos].iov_base = static_cast<char*>(ioVectors[pos].iov_base) + writeSize;
+            ioVectors[pos].iov_len -= static_cast<uint64_t>(writeSize);
+        }
+    }
+
+    close(fd);
+
+    for(uint64_t i = pos; i < batch.size(); i++) {
+        batch[i]->errorMessage = "couldn't append text to file " + filePath;
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * @file        append_queue.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef APPEND_QUEUE_H
+#define APPEND_QUEUE_H
+
+#include <common.h>
+
+#include <condition_variable>
+#include <deque>
+
+class AppendQueue
+{
+public:
+    static AppendQueue* getInstance();
+
+    bool appendText(const std::string &filePath,
+                    const std::string &text,
+                    std::string &errorMessage);
+
+private:
+    struct AppendRequest
+    {
+        const std::string* text = nullptr;
+        bool done = false;
+        bool success = false;
+        std::string errorMessage = "";
+    };
+
+    struct PathQueue
+    {
+        std::mutex lock;
+        std::condition_variable cv;
+        std::deque<AppendRequest*> pending;
+        bool writerActive = false;
+    };
+
+    AppendQueue();
+
+    static AppendQueue* m_instance;
+
+    std::mutex m_lock;
+    std::map<std::string, PathQueue*> m_queues;
+
+    PathQueue* getQueue(const std::string &filePath);
+    void writeBatch(const std::string &filePath, std::deque<AppendRequest*> &batch);
+};
+
+#endif // APPEND_QUEUE_H
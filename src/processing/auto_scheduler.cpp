@@ -0,0 +1,574 @@
+/**
+ * @file        auto_scheduler.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "auto_scheduler.h"
+
+#include <processing/duration_history.h>
+#include <processing/fail_fast.h>
+#include <processing/resource_limits.h>
+#include <processing/thread_pool.h>
+
+#include <libKitsunemimiPersistence/logger/logger.h>
+
+#include <chrono>
+
+AutoScheduler* AutoScheduler::m_instance = nullptr;
+
+/**
+ * @brief get the resources, which are used by a blossom. Files are identified by their
+ *        absolute paths, the package-database and remote hosts by a fixed name. The special
+ *        resource "*" is used by blossoms with unknown side-effects, like commands, and
+ *        conflicts with all other resources.
+ *
+ * @param group group-name of the blossom
+ * @param type type-name of the blossom within the group
+ * @param input input-values of the blossom
+ * @param resources reference for the resulting resources
+ */
+void
+getBlossomResources(const std::string &group,
+                    const std::string &type,
+                    const DataMap &input,
+                    std::vector<std::string> &resources)
+{
+    // commands, exit and blossoms of unknown groups can have any side-effect
+    if((group == "special" && (type == "cmd" || type == "exit"))
+            || (group != "apt"
+                && group != "agent"
+                && group != "ini_file"
+                && group != "path"
+                && group != "special"
+                && group != "ssh"
+                && group != "template"
+                && group != "text_file"))
+    {
+        resources.push_back("*");
+        return;
+    }
+
+    // all package-operations use the same package-database
+    if(group == "apt") {
+        resources.push_back("apt");
+    }
+
+    // remote hosts
+    const std::string address = input.getStringByKey("address");
+    if(address != "") {
+        resources.push_back("host:" + address);
+    }
+
+    // blossoms, which process a list of remote hosts
+    DataItem* hostsItem = input.get("hosts");
+    if(hostsItem != nullptr
+            && hostsItem->isArray())
+    {
+        for(DataItem* host : hostsItem->toArray()->m_array) {
+            resources.push_back("host:" + host->toString());
+        }
+    }
+
+    // local files, where relative paths of source-files point into the tree itself and all
+    // other relative paths are relative to the working-directory
+    const std::vector<std::string> pathKeys = { "file_path", "path", "dest_path", "source_path" };
+    for(const std::string &key : pathKeys)
+    {
+        DataItem* pathItem = input.get(key);
+        if(pathItem == nullptr
+                || pathItem->isValue() == false)
+        {
+            continue;
+        }
+
+        const std::string path = pathItem->toString();
+        if(path.size() == 0
+                || (key == "source_path" && path.at(0) != '/'))
+        {
+            continue;
+        }
+
+        // normalize, so different notations of the same path are detected as the same file
+        bfs::path normalizedPath;
+        try
+        {
+            normalizedPath = bfs::absolute(bfs::path(path)).lexically_normal();
+        }
+        catch(const bfs::filesystem_error &)
+        {
+            resources.push_back("*");
+            return;
+        }
+        if(normalizedPath.filename() == ".") {
+            normalizedPath = normalizedPath.parent_path();
+        }
+
+        // rename changes the content of the parent-directory
+        if(group == "path" && type == "rename") {
+            normalizedPath = normalizedPath.parent_path();
+        }
+
+        resources.push_back("file:" + normalizedPath.string());
+    }
+}
+
+/**
+ * @brief check if two resources can not be used at the same time. File-paths conflict, if they
+ *        are equal or one of them is a parent-directory of the other one.
+ *
+ * @param first first resource
+ * @param second second resource
+ *
+ * @return true, if the resources conflict, else false
+ */
+bool
+isConflict(const std::string &first,
+           const std::string &second)
+{
+    if(first == "*"
+            || second == "*"
+            || first == second)
+    {
+        return true;
+    }
+
+    if(first.compare(0, 5, "file:") != 0
+            || second.compare(0, 5, "file:") != 0)
+    {
+        return false;
+    }
+
+    const std::string &shorter = first.size() < second.size() ? first : second;
+    const std::string &longer = first.size() < second.size() ? second : first;
+
+    return longer.compare(0, shorter.size(), shorter) == 0
+           && (shorter.back() == '/' || longer.at(shorter.size()) == '/');
+}
+
+/**
+ * @brief check if two lists of resources have at least one conflict
+ *
+ * @param first first list of resources
+ * @param second second list of resources
+ *
+ * @return true, if there is a conflict, else false
+ */
+bool
+isConflict(const std::vector<std::string> &first,
+           const std::vector<std::string> &second)
+{
+    for(const std::string &firstResource : first)
+    {
+        for(const std::string &secondResource : second)
+        {
+            if(isConflict(firstResource, secondResource)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief constructor
+ */
+AutoScheduler::AutoScheduler()
+{
+    m_enabled = false;
+}
+
+/**
+ * @brief get instance of the scheduler, which is shared by all threads
+ *
+ * @return pointer to the scheduler
+ */
+AutoScheduler*
+AutoScheduler::getInstance()
+{
+    static std::mutex instanceLock;
+    std::lock_guard<std::mutex> guard(instanceLock);
+
+    if(m_instance == nullptr) {
+        m_instance = new AutoScheduler();
+    }
+
+    return m_instance;
+}
+
+/**
+ * @brief enable or disable the automatic parallelization of blossoms
+ *
+ * @param enabled true to enable
+ */
+void
+AutoScheduler::setEnabled(const bool enabled)
+{
+    m_enabled = enabled;
+}
+
+/**
+ * @brief check if the automatic parallelization is enabled
+ *
+ * @return true, if enabled, else false
+ */
+bool
+AutoScheduler::isEnabled() const
+{
+    return m_enabled;
+}
+
+/**
+ * @brief check if a blossom can be run in background. This is not possible for the blossoms of
+ *        the special-group, because they work on the items of the tree, and for blossoms with
+ *        unknown side-effects. Blossoms with output-values must be checked by the caller,
+ *        because the tree needs their output directly.
+ *
+ * @param group group-name of the blossom
+ * @param type type-name of the blossom within the group
+ *
+ * @return true, if the blossom can run in background, else false
+ */
+bool
+AutoScheduler::canRunAsync(const std::string &group,
+                           const std::string &type) const
+{
+    if(group == "special") {
+        return false;
+    }
+
+    std::vector<std::string> resources;
+    getBlossomResources(group, type, DataMap(), resources);
+
+    return resources.size() == 0
+           || resources.at(0) != "*";
+}
+
+/**
+ * @brief run a blossom in background. It waits only for the previously added blossoms, which
+ *        use the same resources. The input-values are copied, so later changes of the items
+ *        of the tree have no effect on the task.
+ *
+ * @param blossom blossom to run
+ * @param group group-name of the blossom
+ * @param type type-name of the blossom within the group
+ * @param blossomLeaf blossom-leaf with the input-values
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if a previous blossom in background has failed, else true
+ */
+bool
+AutoScheduler::addTask(SakuraBlossom* blossom,
+                       const std::string &group,
+                       const std::string &type,
+                       const BlossomLeaf &blossomLeaf,
+                       std::string &errorMessage)
+{
+    std::shared_ptr<ScheduledTask> task = std::make_shared<ScheduledTask>();
+    task->name = group + " -> " + type + " (" + blossomLeaf.blossomName + ")";
+    task->group = group;
+    task->type = type;
+    task->blossom = blossom;
+    task->durationKey = getDurationKey(group, type, blossomLeaf);
+    DurationHistory* history = DurationHistory::getInstance();
+    task->expectedDuration = history->getExpectedDuration(task->durationKey);
+    getBlossomResources(group, type, blossomLeaf.input, task->resources);
+
+    // copy leaf, because the original one is reused by the tree after this call
+    BlossomLeaf* leafCopy = new BlossomLeaf();
+    leafCopy->blossomType = blossomLeaf.blossomType;
+    leafCopy->blossomGroupType = blossomLeaf.blossomGroupType;
+    leafCopy->nameHirarchie = blossomLeaf.nameHirarchie;
+    leafCopy->blossomName = blossomLeaf.blossomName;
+    leafCopy->blossomPath = blossomLeaf.blossomPath;
+
+    std::map<std::string, DataItem*>::const_iterator it;
+    for(it = blossomLeaf.input.m_map.begin();
+        it != blossomLeaf.input.m_map.end();
+        it++)
+    {
+        leafCopy->input.insert(it->first, it->second->copy());
+    }
+    task->blossomLeaf = leafCopy;
+
+    bool ready = false;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        if(m_failed)
+        {
+            delete leafCopy;
+            errorMessage = m_errorMessage;
+            return false;
+        }
+
+        // register at all pending tasks, which have to be finished before
+        for(std::shared_ptr<ScheduledTask> &pendingTask : m_pendingTasks)
+        {
+            if(isConflict(pendingTask->resources, task->resources))
+            {
+                pendingTask->dependents.push_back(task);
+                task->openDependencies++;
+            }
+        }
+
+        m_pendingTasks.push_back(task);
+        ready = task->openDependencies == 0;
+    }
+
+    LOG_DEBUG("run in background: " + task->name);
+
+    if(ready) {
+        startTask(task);
+    }
+
+    return true;
+}
+
+/**
+ * @brief wait until all blossoms in background, which use resources of the given blossom,
+ *        are finished, so the blossom can run directly afterwards
+ *
+ * @param group group-name of the blossom
+ * @param type type-name of the blossom within the group
+ * @param input input-values of the blossom
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if a blossom in background has failed, else true
+ */
+bool
+AutoScheduler::waitForResources(const std::string &group,
+                                const std::string &type,
+                                const DataMap &input,
+                                std::string &errorMessage)
+{
+    std::vector<std::string> resources;
+    getBlossomResources(group, type, input, resources);
+
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_cv.wait(lock, [this, &resources] { return hasConflict(resources) == false; });
+
+    if(m_failed)
+    {
+        errorMessage = m_errorMessage;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief wait until all blossoms in background are finished and reset the error-state
+ *
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if a blossom in background has failed, else true
+ */
+bool
+AutoScheduler::waitForAll(std::string &errorMessage)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_cv.wait(lock, [this] { return m_pendingTasks.size() == 0; });
+
+    const bool result = m_failed == false;
+    if(m_failed) {
+        errorMessage = m_errorMessage;
+    }
+
+    m_failed = false;
+    m_errorMessage = "";
+
+    return result;
+}
+
+/**
+ * @brief run a task, which doesn't wait for other tasks anymore, in the global thread-pool.
+ *        Blossoms, which can be started asynchronously, use the thread only until their
+ *        process is started and are finished by the callback of the process-reactor.
+ *
+ * @param task task to run
+ */
+void
+AutoScheduler::startTask(std::shared_ptr<ScheduledTask> task)
+{
+    ThreadPool::getInstance()->addTask([this, task]()
+    {
+        ResourceLimits* resourceLimits = ResourceLimits::getInstance();
+        Semaphore* resource = nullptr;
+        std::string errorMessage = "";
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        if(resourceLimits->acquire(task->group,
+                                   task->type,
+                                   task->blossomLeaf->input,
+                                   resource,
+                                   errorMessage,
+                                   task->expectedDuration) == false)
+        {
+            completeTask(task, resource, start, false, errorMessage);
+        }
+        else if(FailFast::getInstance()->isCanceled())
+        {
+            // queued tasks of a canceled run are dropped without execution
+            completeTask(task, resource, start, false, "canceled because of a previous error");
+        }
+        else if(task->blossom->getAllowAsyncStart())
+        {
+            start = std::chrono::steady_clock::now();
+            const bool started = task->blossom->startBlossom(*task->blossomLeaf,
+                                                             [this, task, resource, start]
+                                                             (const bool result,
+                                                              const std::string &error)
+            {
+                completeTask(task, resource, start, result, error);
+            },
+            errorMessage);
+
+            if(started == false) {
+                completeTask(task, resource, start, false, errorMessage);
+            }
+        }
+        else
+        {
+            start = std::chrono::steady_clock::now();
+            const bool result = task->blossom->runBlossom(*task->blossomLeaf, errorMessage);
+            completeTask(task, resource, start, result, errorMessage);
+        }
+    });
+}
+
+/**
+ * @brief record the duration of a finished task, release its resource and finish it
+ *
+ * @param task finished task
+ * @param resource acquired resource of the task, or nullptr
+ * @param start start-time of the task
+ * @param success result of the task
+ * @param errorMessage error-message of the task
+ */
+void
+AutoScheduler::completeTask(std::shared_ptr<ScheduledTask> task,
+                            Semaphore* resource,
+                            const std::chrono::steady_clock::time_point start,
+                            const bool success,
+                            const std::string &errorMessage)
+{
+    if(success)
+    {
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        const long duration =
+                std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        DurationHistory::getInstance()->addDuration(task->durationKey,
+                                                    static_cast<uint64_t>(duration));
+    }
+
+    ResourceLimits::getInstance()->release(resource);
+
+    FailFast* failFast = FailFast::getInstance();
+    if(success == false
+            && failFast->isCanceled() == false)
+    {
+        failFast->cancel("blossom " + task->name + " failed in background: " + errorMessage);
+    }
+
+    finishTask(task, success, errorMessage);
+}
+
+/**
+ * @brief remove a finished task and start all tasks, which have only waited for this task
+ *
+ * @param task finished task
+ * @param success result of the task
+ * @param errorMessage error-message of the task
+ */
+void
+AutoScheduler::finishTask(std::shared_ptr<ScheduledTask> task,
+                          const bool success,
+                          const std::string &errorMessage)
+{
+    std::vector<std::shared_ptr<ScheduledTask>> readyTasks;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        for(uint64_t i = 0; i < m_pendingTasks.size(); i++)
+        {
+            if(m_pendingTasks.at(i) == task)
+            {
+                m_pendingTasks.erase(m_pendingTasks.begin() + static_cast<long>(i));
+                break;
+            }
+        }
+
+        if(success == false
+                && m_failed == false)
+        {
+            m_failed = true;
+            m_errorMessage = "blossom " + task->name + " failed in background: " + errorMessage;
+        }
+
+        for(std::shared_ptr<ScheduledTask> &dependent : task->dependents)
+        {
+            dependent->openDependencies--;
+            if(dependent->openDependencies == 0) {
+                readyTasks.push_back(dependent);
+            }
+        }
+        task->dependents.clear();
+
+        delete task->blossomLeaf;
+        task->blossomLeaf = nullptr;
+    }
+    m_cv.notify_all();
+
+    // start the tasks, which are expected to take longest, first
+    std::stable_sort(readyTasks.begin(),
+                     readyTasks.end(),
+                     [](const std::shared_ptr<ScheduledTask> &a,
+                        const std::shared_ptr<ScheduledTask> &b)
+    {
+        return a->expectedDuration > b->expectedDuration;
+    });
+
+    for(std::shared_ptr<ScheduledTask> &readyTask : readyTasks) {
+        startTask(readyTask);
+    }
+}
+
+/**
+ * @brief check if a pending task conflicts with a list of resources. The lock of the scheduler
+ *        must be hold by the caller.
+ *
+ * @param resources list of resources
+ *
+ * @return true, if there is a conflict, else false
+ */
+bool
+AutoScheduler::hasConflict(const std::vector<std::string> &resources) const
+{
+    for(const std::shared_ptr<ScheduledTask> &pendingTask : m_pendingTasks)
+    {
+        if(isConflict(pendingTask->resources, resources)) {
+            return true;
+        }
+    }
+
+    return false;
+}
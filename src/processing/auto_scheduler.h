@@ -0,0 +1,96 @@
+/**
+ * @file        auto_scheduler.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef AUTO_SCHEDULER_H
+#define AUTO_SCHEDULER_H
+
+#include <common.h>
+#include <blossoms/sakura_blossom.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+
+class Semaphore;
+
+class AutoScheduler
+{
+public:
+    static AutoScheduler* getInstance();
+
+    void setEnabled(const bool enabled);
+    bool isEnabled() const;
+
+    bool canRunAsync(const std::string &group,
+                     const std::string &type) const;
+    bool addTask(SakuraBlossom* blossom,
+                 const std::string &group,
+                 const std::string &type,
+                 const BlossomLeaf &blossomLeaf,
+                 std::string &errorMessage);
+    bool waitForResources(const std::string &group,
+                          const std::string &type,
+                          const DataMap &input,
+                          std::string &errorMessage);
+    bool waitForAll(std::string &errorMessage);
+
+private:
+    struct ScheduledTask
+    {
+        std::string name = "";
+        std::string group = "";
+        std::string type = "";
+        std::string durationKey = "";
+        uint64_t expectedDuration = 0;
+        std::vector<std::string> resources;
+        SakuraBlossom* blossom = nullptr;
+        BlossomLeaf* blossomLeaf = nullptr;
+        uint32_t openDependencies = 0;
+        std::vector<std::shared_ptr<ScheduledTask>> dependents;
+    };
+
+    AutoScheduler();
+
+    static AutoScheduler* m_instance;
+
+    std::atomic<bool> m_enabled;
+    std::mutex m_lock;
+    std::condition_variable m_cv;
+    std::vector<std::shared_ptr<ScheduledTask>> m_pendingTasks;
+    bool m_failed = false;
+    std::string m_errorMessage = "";
+
+    void startTask(std::shared_ptr<ScheduledTask> task);
+    void completeTask(std::shared_ptr<ScheduledTask> task,
+                      Semaphore* resource,
+                      const std::chrono::steady_clock::time_point start,
+                      const bool success,
+                      const std::string &errorMessage);
+    void finishTask(std::shared_ptr<ScheduledTask> task,
+                    const bool success,
+                    const std::string &errorMessage);
+    bool hasConflict(const std::vector<std::string> &resources) const;
+};
+
+#endif // AUTO_SCHEDULER_H
@@ -0,0 +1,263 @@
+/**
+ * @file        blossom_wrapper.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "blossom_wrapper.h"
+
+#include <processing/auto_scheduler.h>
+#include <processing/duration_history.h>
+#include <processing/fail_fast.h>
+#include <processing/output_bindings.h>
+#include <processing/resource_limits.h>
+#include <processing/semaphore.h>
+#include <processing/thread_pool.h>
+
+#include <chrono>
+
+Semaphore* BlossomWrapper::m_executionLimit = nullptr;
+std::mutex BlossomWrapper::m_outputLock;
+DataMap* BlossomWrapper::m_collectedOutputs = nullptr;
+
+/**
+ * @brief constructor, which takes over the validation-definitions of the wrapped blossom, so
+ *        the wrapper can be registered instead of the original blossom
+ *
+ * @param blossom blossom to wrap
+ * @param group group-name of the blossom
+ * @param type type-name of the blossom within the group
+ */
+BlossomWrapper::BlossomWrapper(SakuraBlossom* blossom,
+                               const std::string &group,
+                               const std::string &type)
+    : SakuraBlossom(),
+      m_blossom(blossom),
+      m_group(group),
+      m_type(type)
+{
+    validationMap = m_blossom->getValidationMap();
+    allowUnmatched = m_blossom->getAllowUnmatched();
+
+    // each blossom can select or define the resource, which limits its parallel execution
+    validationMap.emplace("resource_limit", BlossomValidDef(IO_ValueType::INPUT_TYPE, false));
+
+    // blossoms with output-values can only run in background, if the call-site doesn't use
+    // the output, which is checked for each call
+    std::map<std::string, BlossomValidDef>::const_iterator it;
+    for(it = validationMap.begin();
+        it != validationMap.end();
+        it++)
+    {
+        if(it->second.type == IO_ValueType::OUTPUT_TYPE) {
+            m_hasOutputs = true;
+        }
+    }
+}
+
+/**
+ * @brief destructor
+ */
+BlossomWrapper::~BlossomWrapper()
+{
+    delete m_blossom;
+}
+
+/**
+ * @brief get the wrapped blossom
+ *
+ * @return pointer to the original blossom
+ */
+SakuraBlossom*
+BlossomWrapper::getBlossom() const
+{
+    return m_blossom;
+}
+
+/**
+ * @brief get the global limit for blossoms, which are running at the same time. It has the
+ *        same size like the global thread-pool, which is defined by the max-threads-flag.
+ *
+ * @return pointer to the semaphore
+ */
+Semaphore*
+BlossomWrapper::getExecutionLimit()
+{
+    static std::mutex limitLock;
+    std::lock_guard<std::mutex> guard(limitLock);
+
+    if(m_executionLimit == nullptr) {
+        m_executionLimit = new Semaphore(ThreadPool::getInstance()->getNumberOfThreads());
+    }
+
+    return m_executionLimit;
+}
+
+/**
+ * @brief collect the output-values of all following blossoms, so an agent can give the outputs
+ *        of its subtree back to the controller
+ */
+void
+BlossomWrapper::enableOutputCollection()
+{
+    std::lock_guard<std::mutex> guard(m_outputLock);
+
+    if(m_collectedOutputs == nullptr) {
+        m_collectedOutputs = new DataMap();
+    }
+}
+
+/**
+ * @brief get all collected output-values, where an output of a later blossom overrides an
+ *        output with the same name of an earlier blossom
+ *
+ * @return collected output-values as json-string
+ */
+const std::string
+BlossomWrapper::getCollectedOutputs()
+{
+    std::lock_guard<std::mutex> guard(m_outputLock);
+
+    if(m_collectedOutputs == nullptr) {
+        return "{}";
+    }
+
+    return m_collectedOutputs->toString();
+}
+
+/**
+ * @brief add the output-values of a blossom to the collected outputs, if enabled
+ *
+ * @param output output-values of the blossom
+ */
+void
+BlossomWrapper::collectOutputs(const DataMap &output)
+{
+    std::lock_guard<std::mutex> guard(m_outputLock);
+
+    if(m_collectedOutputs == nullptr) {
+        return;
+    }
+
+    std::map<std::string, DataItem*>::const_iterator it;
+    for(it = output.m_map.begin();
+        it != output.m_map.end();
+        it++)
+    {
+        m_collectedOutputs->insert(it->first, it->second->copy(), true);
+    }
+}
+
+/**
+ * @brief runTask
+ */
+bool
+BlossomWrapper::runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage)
+{
+    // after the first error of a fail-fast-run no new blossom is started
+    FailFast* failFast = FailFast::getInstance();
+    if(failFast->isCanceled())
+    {
+        errorMessage = "canceled because of a previous error";
+        return false;
+    }
+
+    // with automatic parallelization, independent blossoms are moved into background and all
+    // other ones wait only for the blossoms in background, which use the same resources
+    AutoScheduler* scheduler = AutoScheduler::getInstance();
+    if(scheduler->isEnabled())
+    {
+        OutputBindings* bindings = OutputBindings::getInstance();
+        if(scheduler->canRunAsync(m_group, m_type)
+                && (m_hasOutputs == false
+                    || bindings->hasBoundOutputs(blossomLeaf.blossomPath,
+                                                 blossomLeaf.blossomName,
+                                                 m_type) == false))
+        {
+            return scheduler->addTask(m_blossom, m_group, m_type, blossomLeaf, errorMessage);
+        }
+
+        if(scheduler->waitForResources(m_group, m_type, blossomLeaf.input, errorMessage) == false) {
+            return false;
+        }
+    }
+
+    // blossoms, which took longest in previous runs, get free slots first, so a slow branch
+    // is not started last and stretches the whole run
+    DurationHistory* history = DurationHistory::getInstance();
+    const std::string durationKey = getDurationKey(m_group, m_type, blossomLeaf);
+    const uint64_t expectedDuration = history->getExpectedDuration(durationKey);
+
+    // wait for the resource of the blossom first, so waiting blossoms don't block the global
+    // limit for other blossoms
+    ResourceLimits* resourceLimits = ResourceLimits::getInstance();
+    Semaphore* resource = nullptr;
+    if(resourceLimits->acquire(m_group,
+                               m_type,
+                               blossomLeaf.input,
+                               resource,
+                               errorMessage,
+                               expectedDuration) == false)
+    {
+        failFast->cancel("blossom " + m_group + " -> " + m_type
+                         + " (" + blossomLeaf.blossomName + ") failed: " + errorMessage);
+        return false;
+    }
+
+    // limit the number of blossoms, which are running at the same time, independent of the
+    // number of parallel branches of the tree
+    Semaphore* executionLimit = getExecutionLimit();
+    executionLimit->acquire(expectedDuration);
+
+    // the run could have been canceled while waiting for the limits
+    bool result = false;
+    if(failFast->isCanceled())
+    {
+        errorMessage = "canceled because of a previous error";
+    }
+    else
+    {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        result = m_blossom->runBlossom(blossomLeaf, errorMessage);
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        // durations of failed blossoms say nothing about the next successful run
+        if(result)
+        {
+            const long duration =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+            history->addDuration(durationKey, static_cast<uint64_t>(duration));
+            collectOutputs(blossomLeaf.output);
+        }
+    }
+
+    executionLimit->release();
+
+    resourceLimits->release(resource);
+
+    if(result == false
+            && failFast->isCanceled() == false)
+    {
+        failFast->cancel("blossom " + m_group + " -> " + m_type
+                         + " (" + blossomLeaf.blossomName + ") failed: " + errorMessage);
+    }
+
+    return result;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file        blossom_wrapper.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef BLOSSOM_WRAPPER_H
+#define BLOSSOM_WRAPPER_H
+
+#include <common.h>
+#include <blossoms/sakura_blossom.h>
+
+class Semaphore;
+
+class BlossomWrapper
+        : public SakuraBlossom
+{
+public:
+    BlossomWrapper(SakuraBlossom* blossom,
+                   const std::string &group,
+                   const std::string &type);
+    ~BlossomWrapper();
+
+    SakuraBlossom* getBlossom() const;
+
+    static void enableOutputCollection();
+    static const std::string getCollectedOutputs();
+
+protected:
+    bool runTask(BlossomLeaf &blossomLeaf, std::string &errorMessage);
+
+private:
+    static Semaphore* m_executionLimit;
+    static std::mutex m_outputLock;
+    static DataMap* m_collectedOutputs;
+
+    SakuraBlossom* m_blossom = nullptr;
+    const std::string m_group;
+    const std::string m_type;
+    bool m_hasOutputs = false;
+
+    static Semaphore* getExecutionLimit();
+    static void collectOutputs(const DataMap &output);
+};
+
+#endif // BLOSSOM_WRAPPER_H
@@ -0,0 +1,275 @@
+/**
+ * @file        duration_history.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "duration_history.h"
+
+#include <helper/file_helper.h>
+
+#include <libKitsunemimiCommon/common_methods/string_methods.h>
+#include <libKitsunemimiPersistence/files/text_file.h>
+
+DurationHistory* DurationHistory::m_instance = nullptr;
+
+/**
+ * @brief remove characters, which are used as separators within the history-file
+ *
+ * @param input string to clean
+ *
+ * @return string without tabs and line-breaks
+ */
+const std::string
+cleanKeyPart(const std::string &input)
+{
+    std::string result = input;
+    for(char &c : result)
+    {
+        if(c == '\t' || c == '\n' || c == '\r') {
+            c = ' ';
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief get the key of a blossom within the history, which consists of the file of the
+ *        blossom, the name of the blossom and the remote host, where it is running
+ *
+ * @param group group-name of the blossom
+ * @param type type-name of the blossom within the group
+ * @param blossomLeaf blossom-leaf with the input-values
+ *
+ * @return key of the blossom
+ */
+const std::string
+getDurationKey(const std::string &group,
+               const std::string &type,
+               const BlossomLeaf &blossomLeaf)
+{
+    std::string host = blossomLeaf.input.getStringByKey("address");
+    if(host == "") {
+        host = "localhost";
+    }
+
+    const std::string name = group + "." + type + ":" + blossomLeaf.blossomName;
+
+    return cleanKeyPart(blossomLeaf.blossomPath)
+           + "\t" + cleanKeyPart(name)
+           + "\t" + cleanKeyPart(host);
+}
+
+/**
+ * @brief constructor
+ */
+DurationHistory::DurationHistory()
+{
+    m_enabled = false;
+}
+
+/**
+ * @brief get instance of the history, which is shared by all threads
+ *
+ * @return pointer to the history
+ */
+DurationHistory*
+DurationHistory::getInstance()
+{
+    static std::mutex instanceLock;
+    std::lock_guard<std::mutex> guard(instanceLock);
+
+    if(m_instance == nullptr) {
+        m_instance = new DurationHistory();
+    }
+
+    return m_instance;
+}
+
+/**
+ * @brief read the durations of previous runs and enable the recording of new durations. Each
+ *        line of the file has the form <duration in ms>\t<count>\t<file>\t<blossom>\t<host>.
+ *        A missing file is not an error, because it is created at the end of the first run.
+ *
+ * @param filePath path of the history-file
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if the file exists, but couldn't be read, else true
+ */
+bool
+DurationHistory::load(const std::string &filePath,
+                      std::string &errorMessage)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    m_filePath = filePath;
+    m_entries.clear();
+    m_enabled = true;
+
+    if(bfs::exists(filePath) == false) {
+        return true;
+    }
+
+    std::string content = "";
+    if(Kitsunemimi::Persistence::readFile(content, filePath, errorMessage) == false) {
+        return false;
+    }
+
+    std::vector<std::string> lines;
+    Kitsunemimi::splitStringByDelimiter(lines, content, '\n');
+    for(const std::string &line : lines)
+    {
+        // split manually, because the parts of the key can be empty
+        std::vector<std::string> parts;
+        uint64_t start = 0;
+        while(true)
+        {
+            const uint64_t end = line.find('\t', start);
+            parts.push_back(line.substr(start, end - start));
+            if(end == std::string::npos) {
+                break;
+            }
+            start = end + 1;
+        }
+
+        // ignore broken lines instead of failing the whole run
+        if(parts.size() != 5
+                || parts.at(0).size() == 0
+                || parts.at(0).size() > 18
+                || parts.at(1).size() == 0
+                || parts.at(1).size() > 18
+                || parts.at(0).find_first_not_of("0123456789") != std::string::npos
+                || parts.at(1).find_first_not_of("0123456789") != std::string::npos)
+        {
+            continue;
+        }
+
+        DurationEntry entry;
+        entry.duration = std::stoull(parts.at(0));
+        entry.count = std::stoull(parts.at(1));
+
+        const std::string key = parts.at(2) + "\t" + parts.at(3) + "\t" + parts.at(4);
+        m_entries[key] = entry;
+    }
+
+    return true;
+}
+
+/**
+ * @brief write all durations back into the history-file
+ *
+ * @param errorMessage reference for error-message
+ *
+ * @return true, if successful, else false
+ */
+bool
+DurationHistory::save(std::string &errorMessage)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(m_enabled == false) {
+        return true;
+    }
+
+    const bfs::path parentPath = bfs::path(m_filePath).parent_path();
+    if(parentPath.string() != "")
+    {
+        boost::system::error_code error;
+        bfs::create_directories(parentPath, error);
+        if(error)
+        {
+            errorMessage = "couldn't create directory " + parentPath.string()
+                           + " for the duration-history: " + error.message();
+            return false;
+        }
+    }
+
+    std::string content = "";
+    std::map<std::string, DurationEntry>::const_iterator it;
+    for(it = m_entries.begin();
+        it != m_entries.end();
+        it++)
+    {
+        content += std::to_string(it->second.duration) + "\t"
+                   + std::to_string(it->second.count) + "\t"
+                   + it->first + "\n";
+    }
+
+    uint64_t hash = 0;
+    bool changed = false;
+    return writeFileAtomic(m_filePath, content, hash, changed, errorMessage);
+}
+
+/**
+ * @brief check if durations are recorded
+ *
+ * @return true, if a history-file was loaded, else false
+ */
+bool
+DurationHistory::isEnabled() const
+{
+    return m_enabled;
+}
+
+/**
+ * @brief get the expected duration of a blossom based on the previous runs
+ *
+ * @param key key of the blossom
+ *
+ * @return expected duration in milliseconds or 0, if unknown
+ */
+uint64_t
+DurationHistory::getExpectedDuration(const std::string &key)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    std::map<std::string, DurationEntry>::const_iterator it;
+    it = m_entries.find(key);
+    if(it == m_entries.end()) {
+        return 0;
+    }
+
+    return it->second.duration;
+}
+
+/**
+ * @brief add a measured duration of a blossom. The expected duration is the average of the
+ *        measured ones, where only the last few runs have a relevant weight, so the history
+ *        follows changes of the environment.
+ *
+ * @param key key of the blossom
+ * @param duration measured duration in milliseconds
+ */
+void
+DurationHistory::addDuration(const std::string &key,
+                             const uint64_t duration)
+{
+    if(m_enabled == false) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    DurationEntry &entry = m_entries[key];
+    const uint64_t weight = std::min(entry.count, static_cast<uint64_t>(4));
+    entry.duration = (entry.duration * weight + duration) / (weight + 1);
+    entry.count++;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file        duration_history.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef DURATION_HISTORY_H
+#define DURATION_HISTORY_H
+
+#include <common.h>
+
+#include <atomic>
+
+const std::string getDurationKey(const std::string &group,
+                                 const std::string &type,
+                                 const BlossomLeaf &blossomLeaf);
+
+class DurationHistory
+{
+public:
+    static DurationHistory* getInstance();
+
+    bool load(const std::string &filePath, std::string &errorMessage);
+    bool save(std::string &errorMessage);
+    bool isEnabled() const;
+
+    uint64_t getExpectedDuration(const std::string &key);
+    void addDuration(const std::string &key, const uint64_t duration);
+
+private:
+    struct DurationEntry
+    {
+        uint64_t duration = 0;
+        uint64_t count = 0;
+    };
+
+    DurationHistory();
+
+    static DurationHistory* m_instance;
+
+    std::atomic<bool> m_enabled;
+    std::mutex m_lock;
+    std::string m_filePath = "";
+    std::map<std::string, DurationEntry> m_entries;
+};
+
+#endif // DURATION_HISTORY_H
@@ -0,0 +1,154 @@
+/**
+ * @file        fail_fast.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "fail_fast.h"
+
+#include <processing/process_reactor.h>
+
+#include <libKitsunemimiPersistence/logger/logger.h>
+
+#include <signal.h>
+
+FailFast* FailFast::m_instance = nullptr;
+
+/**
+ * @brief constructor
+ */
+FailFast::FailFast()
+{
+    m_enabled = false;
+    m_canceled = false;
+}
+
+/**
+ * @brief get instance of the cancellation-state, which is shared by all branches of the tree
+ *
+ * @return pointer to the instance
+ */
+FailFast*
+FailFast::getInstance()
+{
+    static std::mutex instanceLock;
+    std::lock_guard<std::mutex> guard(instanceLock);
+
+    if(m_instance == nullptr) {
+        m_instance = new FailFast();
+    }
+
+    return m_instance;
+}
+
+/**
+ * @brief enable or disable the cancellation of all branches on the first error
+ *
+ * @param enabled true to enable
+ */
+void
+FailFast::setEnabled(const bool enabled)
+{
+    m_enabled = enabled;
+}
+
+/**
+ * @brief check if fail-fast is enabled
+ *
+ * @return true, if enabled, else false
+ */
+bool
+FailFast::isEnabled() const
+{
+    return m_enabled;
+}
+
+/**
+ * @brief cancel the run because of an error, if fail-fast is enabled. Only the first error is
+ *        reported directly, all following ones are only the result of the cancellation. The
+ *        process-groups of all running commands get a SIGTERM and a SIGKILL, if they are still
+ *        running after a grace-period.
+ *
+ * @param errorMessage error-message, which is the reason for the cancellation
+ */
+void
+FailFast::cancel(const std::string &errorMessage)
+{
+    if(m_enabled == false) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if(m_canceled) {
+            return;
+        }
+
+        m_firstError = errorMessage;
+        m_canceled = true;
+    }
+
+    LOG_ERROR(errorMessage);
+    LOG_ERROR("fail-fast: cancel all other branches");
+
+    ProcessReactor* reactor = ProcessReactor::getInstance();
+    reactor->killAll(SIGTERM);
+
+    std::thread killThread([reactor]()
+    {
+        sleep(5);
+        reactor->killAll(SIGKILL);
+    });
+    killThread.detach();
+}
+
+/**
+ * @brief check if the run was canceled, so no new work should be started
+ *
+ * @return true, if canceled, else false
+ */
+bool
+FailFast::isCanceled() const
+{
+    return m_canceled;
+}
+
+/**
+ * @brief get the error, which has caused the cancellation
+ *
+ * @return first error-message
+ */
+const std::string
+FailFast::getFirstError()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_firstError;
+}
+
+/**
+ * @brief reset the cancellation-state for a new run
+ */
+void
+FailFast::reset()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_firstError = "";
+    m_canceled = false;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file        fail_fast.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef FAIL_FAST_H
+#define FAIL_FAST_H
+
+#include <common.h>
+
+#include <atomic>
+
+class FailFast
+{
+public:
+    static FailFast* getInstance();
+
+    void setEnabled(const bool enabled);
+    bool isEnabled() const;
+
+    void cancel(const std::string &errorMessage);
+    bool isCanceled() const;
+    const std::string getFirstError();
+    void reset();
+
+private:
+    FailFast();
+
+    static FailFast* m_instance;
+
+    std::atomic<bool> m_enabled;
+    std::atomic<bool> m_canceled;
+    std::mutex m_lock;
+    std::string m_firstError = "";
+};
+
+#endif // FAIL_FAST_H
@@ -0,0 +1,218 @@
+/**
+ * @file        output_bindings.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "output_bindings.h"
+
+#include <libKitsunemimiPersistence/files/text_file.h>
+
+#include <regex>
+
+OutputBindings* OutputBindings::m_instance = nullptr;
+
+/**
+ * @brief constructor
+ */
+OutputBindings::OutputBindings() {}
+
+/**
+ * @brief get instance, which caches the output-bindings of all files of the tree
+ *
+ * @return pointer to the instance
+ */
+OutputBindings*
+OutputBindings::getInstance()
+{
+    static std::mutex instanceLock;
+    std::lock_guard<std::mutex> guard(instanceLock);
+
+    if(m_instance == nullptr) {
+        m_instance = new OutputBindings();
+    }
+
+    return m_instance;
+}
+
+/**
+ * @brief check if an output-value of a blossom is bound to an item of the tree with ">>" at
+ *        the call-site of the blossom. If the call-site can not be found clearly, it is
+ *        assumed, that outputs are bound.
+ *
+ * @param filePath path of the sakura-file of the blossom
+ * @param blossomName name of the blossom within the file
+ * @param type type-name of the blossom within the group
+ *
+ * @return false, if no output of the blossom is used by the tree, else true
+ */
+bool
+OutputBindings::hasBoundOutputs(const std::string &filePath,
+                                const std::string &blossomName,
+                                const std::string &type)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    FileBindings* bindings = getBindings(filePath);
+    if(bindings->readable == false
+            || bindings->blossomNames.find(blossomName) == bindings->blossomNames.end())
+    {
+        return true;
+    }
+
+    // bindings before the first type of a blossom are valid for all of its types
+    return bindings->boundTypes.find(blossomName + "\t" + type) != bindings->boundTypes.end()
+           || bindings->boundTypes.find(blossomName + "\t") != bindings->boundTypes.end();
+}
+
+/**
+ * @brief check if a specific output-value of a blossom is bound to an item of the tree with
+ *        ">>" at the call-site of the blossom, so blossoms can skip the creation of expensive
+ *        outputs, which are not used. If the call-site can not be found clearly, it is assumed,
+ *        that the output is bound.
+ *
+ * @param filePath path of the sakura-file of the blossom
+ * @param blossomName name of the blossom within the file
+ * @param type type-name of the blossom within the group
+ * @param outputName name of the output-value
+ *
+ * @return false, if the output is not used by the tree, else true
+ */
+bool
+OutputBindings::isOutputBound(const std::string &filePath,
+                              const std::string &blossomName,
+                              const std::string &type,
+                              const std::string &outputName)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    FileBindings* bindings = getBindings(filePath);
+    if(bindings->readable == false
+            || bindings->blossomNames.find(blossomName) == bindings->blossomNames.end())
+    {
+        return true;
+    }
+
+    // bindings, whose output-name couldn't be parsed, are valid for all outputs
+    const std::vector<std::string> keys = { blossomName + "\t" + type + "\t" + outputName,
+                                            blossomName + "\t" + type + "\t",
+                                            blossomName + "\t\t" + outputName,
+                                            blossomName + "\t\t" };
+    for(const std::string &key : keys)
+    {
+        if(bindings->boundOutputs.find(key) != bindings->boundOutputs.end()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief get the bindings of a sakura-file and parse the file, if not already done. The lock
+ *        must be hold.
+ *
+ * @param filePath path of the sakura-file
+ *
+ * @return bindings of the file
+ */
+OutputBindings::FileBindings*
+OutputBindings::getBindings(const std::string &filePath)
+{
+    std::map<std::string, FileBindings*>::const_iterator it;
+    it = m_files.find(filePath);
+    if(it != m_files.end()) {
+        return it->second;
+    }
+
+    FileBindings* bindings = parseFile(filePath);
+    m_files.insert(std::make_pair(filePath, bindings));
+
+    return bindings;
+}
+
+/**
+ * @brief search all output-bindings within a sakura-file. A blossom starts with a line like
+ *        'group("name")', its types with lines like '-> type:' and each line with '>>' binds
+ *        an output of the current type. Blossoms with the same name within a file are merged.
+ *
+ * @param filePath path of the sakura-file
+ *
+ * @return bindings of the file
+ */
+OutputBindings::FileBindings*
+OutputBindings::parseFile(const std::string &filePath)
+{
+    FileBindings* bindings = new FileBindings();
+
+    std::string content = "";
+    std::string errorMessage = "";
+    if(Kitsunemimi::Persistence::readFile(content, filePath, errorMessage) == false) {
+        return bindings;
+    }
+    bindings->readable = true;
+
+    const std::regex blossomRegex("^\\s*[A-Za-z_][A-Za-z0-9_]*"
+                                  "\\s*\\(\\s*\"([^\"]*)\"\\s*\\)\\s*$");
+    const std::regex typeRegex("^\\s*->\\s*([A-Za-z_][A-Za-z0-9_]*)\\s*:?\\s*$");
+    const std::regex outputRegex("^\\s*-\\s*([A-Za-z_][A-Za-z0-9_]*)\\s*>>");
+
+    std::string blossomName = "";
+    std::string type = "";
+    bool inBlossom = false;
+
+    std::istringstream stream(content);
+    std::string line;
+    while(std::getline(stream, line))
+    {
+        std::smatch match;
+        if(std::regex_match(line, match, blossomRegex))
+        {
+            blossomName = match[1].str();
+            type = "";
+            inBlossom = true;
+            bindings->blossomNames.insert(blossomName);
+            continue;
+        }
+
+        if(inBlossom == false) {
+            continue;
+        }
+
+        if(std::regex_match(line, match, typeRegex))
+        {
+            type = match[1].str();
+            continue;
+        }
+
+        if(line.find(">>") != std::string::npos)
+        {
+            bindings->boundTypes.insert(blossomName + "\t" + type);
+
+            std::string outputName = "";
+            if(std::regex_search(line, match, outputRegex)) {
+                outputName = match[1].str();
+            }
+            bindings->boundOutputs.insert(blossomName + "\t" + type + "\t" + outputName);
+        }
+    }
+
+    return bindings;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file        output_bindings.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef OUTPUT_BINDINGS_H
+#define OUTPUT_BINDINGS_H
+
+#include <common.h>
+
+#include <set>
+
+class OutputBindings
+{
+public:
+    static OutputBindings* getInstance();
+
+    bool hasBoundOutputs(const std::string &filePath,
+                         const std::string &blossomName,
+                         const std::string &type);
+    bool isOutputBound(const std::string &filePath,
+                       const std::string &blossomName,
+                       const std::string &type,
+                       const std::string &outputName);
+
+private:
+    struct FileBindings
+    {
+        bool readable = false;
+        std::set<std::string> blossomNames;
+        std::set<std::string> boundTypes;
+        std::set<std::string> boundOutputs;
+    };
+
+    OutputBindings();
+
+    static OutputBindings* m_instance;
+
+    std::mutex m_lock;
+    std::map<std::string, FileBindings*> m_files;
+
+    FileBindings* getBindings(const std::string &filePath);
+    FileBindings* parseFile(const std::string &filePath);
+};
+
+#endif // OUTPUT_BINDINGS_H
@@ -0,0 +1,466 @@
+/**
+ * @file        process_reactor.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "process_reactor.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#include <processing/fail_fast.h>
+
+#include <libKitsunemimiPersistence/logger/logger.h>
+
+ProcessReactor* ProcessReactor::m_instance = nullptr;
+
+/**
+ * @brief run a command and wait until it is finished. This is a replacement for runSyncProcess,
+ *        where the process is supervised by the reactor instead of the waiting thread.
+ *
+ * @param command command to run within a shell
+ *
+ * @return result of the process with the combined output of stdout and stderr
+ */
+ProcessResult
+runProcess(const std::string &command)
+{
+    return ProcessReactor::getInstance()->runProcess(command);
+}
+
+/**
+ * @brief constructor, which starts the reactor-thread
+ */
+ProcessReactor::ProcessReactor()
+{
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_thread = new std::thread(&ProcessReactor::run, this);
+    m_thread->detach();
+}
+
+/**
+ * @brief get instance of the reactor, which supervises all child-processes with one thread
+ *
+ * @return pointer to the reactor
+ */
+ProcessReactor*
+ProcessReactor::getInstance()
+{
+    static std::mutex instanceLock;
+    std::lock_guard<std::mutex> guard(instanceLock);
+
+    if(m_instance == nullptr) {
+        m_instance = new ProcessReactor();
+    }
+
+    return m_instance;
+}
+
+/**
+ * @brief start a command in background and call a callback, when the process has exited. The
+ *        end of the process is detected by a pidfd and its output is read by the reactor-thread
+ *        over epoll, so there is no thread, which blocks while the process is running. Each
+ *        process gets its own process-group, so it can be killed together with its children.
+ *
+ * @param command command to run within a shell
+ * @param callback function, which is called by the reactor-thread with the result
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if the process couldn't be started, else true
+ */
+bool
+ProcessReactor::startProcess(const std::string &command,
+                             const std::function<void(const ProcessResult&)> &callback,
+                             std::string &errorMessage)
+{
+    if(m_epollFd < 0)
+    {
+        errorMessage = "event-loop for processes is not available";
+        return false;
+    }
+
+    if(FailFast::getInstance()->isCanceled())
+    {
+        errorMessage = "canceled because of a previous error";
+        return false;
+    }
+
+    int outputPipe[2];
+    if(pipe2(outputPipe, O_CLOEXEC) != 0)
+    {
+        errorMessage = "couldn't create pipe for process: " + std::string(strerror(errno));
+        return false;
+    }
+
+    // prepare everything before fork, because only async-signal-safe functions are allowed
+    // in the child of a multi-threaded process. The command is wrapped like by runSyncProcess
+    // of the common-library, so the quotes, which are escaped by the callers, are resolved.
+    const std::string shellCommand = "/bin/bash -c \"" + command + "\"";
+    const char* commandString = shellCommand.c_str();
+
+    const pid_t pid = fork();
+    if(pid < 0)
+    {
+        close(outputPipe[0]);
+        close(outputPipe[1]);
+        errorMessage = "couldn't start process: " + std::string(strerror(errno));
+        return false;
+    }
+
+    if(pid == 0)
+    {
+        setpgid(0, 0);
+        const int nullFd = open("/dev/null", O_RDONLY);
+        if(nullFd >= 0) {
+            dup2(nullFd, STDIN_FILENO);
+        }
+        dup2(outputPipe[1], STDOUT_FILENO);
+        dup2(outputPipe[1], STDERR_FILENO);
+        execl("/bin/sh", "sh", "-c", commandString, static_cast<char*>(nullptr));
+        _exit(127);
+    }
+
+    // set process-group also in the parent to avoid a race with killing the group
+    setpgid(pid, pid);
+    close(outputPipe[1]);
+    fcntl(outputPipe[0], F_SETFL, fcntl(outputPipe[0], F_GETFL) | O_NONBLOCK);
+
+    ChildProcess* child = new ChildProcess();
+    child->pid = pid;
+    child->outputFd = outputPipe[0];
+    child->callback = callback;
+#ifdef SYS_pidfd_open
+    child->pidFd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#endif
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    m_children.insert(std::make_pair(pid, child));
+    m_fdToChild.insert(std::make_pair(child->outputFd, child));
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = child->outputFd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, child->outputFd, &event);
+
+    // without pidfd (kernel older than 5.3) the end of the output is used as end of the process
+    if(child->pidFd >= 0)
+    {
+        fcntl(child->pidFd, F_SETFD, FD_CLOEXEC);
+        m_fdToChild.insert(std::make_pair(child->pidFd, child));
+        event.data.fd = child->pidFd;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, child->pidFd, &event);
+    }
+
+    // the run could have been canceled while the process was started, so it would have been
+    // missed by killAll
+    if(FailFast::getInstance()->isCanceled()) {
+        kill(-pid, SIGKILL);
+    }
+
+    return true;
+}
+
+/**
+ * @brief run a command and wait until it is finished
+ *
+ * @param command command to run within a shell
+ *
+ * @return result of the process with the combined output of stdout and stderr
+ */
+ProcessResult
+ProcessReactor::runProcess(const std::string &command)
+{
+    std::shared_ptr<std::promise<ProcessResult>> promise;
+    promise = std::make_shared<std::promise<ProcessResult>>();
+    std::future<ProcessResult> future = promise->get_future();
+
+    std::string errorMessage = "";
+    const bool started = startProcess(command,
+                                      [promise](const ProcessResult &result)
+    {
+        promise->set_value(result);
+    },
+    errorMessage);
+
+    if(started == false)
+    {
+        ProcessResult result;
+        result.success = false;
+        result.processOutput = errorMessage;
+        return result;
+    }
+
+    return future.get();
+}
+
+/**
+ * @brief get number of processes, which are supervised at the moment
+ *
+ * @return number of running processes
+ */
+uint64_t
+ProcessReactor::getNumberOfRunningProcesses()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_children.size();
+}
+
+/**
+ * @brief send a signal to the process-groups of all running processes, so also the
+ *        sub-processes of the commands are reached
+ *
+ * @param signal signal to send
+ */
+void
+ProcessReactor::killAll(const int signal)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    std::map<pid_t, ChildProcess*>::const_iterator it;
+    for(it = m_children.begin();
+        it != m_children.end();
+        it++)
+    {
+        if(it->second->exited == false) {
+            kill(-it->first, signal);
+        }
+    }
+}
+
+/**
+ * @brief loop of the reactor-thread, which reads the output of all processes and finishes
+ *        processes, which have exited
+ */
+void
+ProcessReactor::run()
+{
+    struct epoll_event events[64];
+    int timeout = -1;
+
+    while(true)
+    {
+        const int numberOfEvents = epoll_wait(m_epollFd, events, 64, timeout);
+        if(numberOfEvents < 0)
+        {
+            if(errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("event-loop for processes failed: " + std::string(strerror(errno)));
+            return;
+        }
+
+        std::vector<ChildProcess*> finishedChildren;
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+
+            for(int i = 0; i < numberOfEvents; i++)
+            {
+                std::map<int, ChildProcess*>::const_iterator it;
+                it = m_fdToChild.find(events[i].data.fd);
+                if(it == m_fdToChild.end()) {
+                    continue;
+                }
+
+                ChildProcess* child = it->second;
+                if(events[i].data.fd == child->outputFd)
+                {
+                    readOutput(child);
+
+                    // without pidfd the process is reaped without blocking, after its output
+                    // was closed, and if it is still running, it is checked again later
+                    if(child->outputClosed
+                            && child->pidFd < 0)
+                    {
+                        reapChild(child);
+                        if(child->exited == false) {
+                            m_numberOfUnreapedChildren++;
+                        }
+                    }
+                }
+                else if(events[i].data.fd == child->pidFd)
+                {
+                    // read the rest of the output, but don't wait for the end of the output,
+                    // because background-processes of the command could still hold the pipe
+                    reapChild(child);
+                    if(child->exited)
+                    {
+                        readOutput(child);
+                        closeOutput(child);
+                    }
+                }
+
+                if(child->exited
+                        && child->outputClosed)
+                {
+                    m_children.erase(child->pid);
+                    finishedChildren.push_back(child);
+                }
+            }
+
+            // check processes without pidfd, which have closed their output before they exited
+            if(m_numberOfUnreapedChildren > 0)
+            {
+                std::map<pid_t, ChildProcess*>::iterator it = m_children.begin();
+                while(it != m_children.end())
+                {
+                    ChildProcess* child = it->second;
+                    if(child->outputClosed == false
+                            || child->pidFd >= 0)
+                    {
+                        it++;
+                        continue;
+                    }
+
+                    reapChild(child);
+                    if(child->exited == false)
+                    {
+                        it++;
+                        continue;
+                    }
+
+                    m_numberOfUnreapedChildren--;
+                    finishedChildren.push_back(child);
+                    it = m_children.erase(it);
+                }
+            }
+
+            // there is no event for the exit of a process without pidfd, so the reactor polls
+            // in short intervals, while such a process is running
+            timeout = m_numberOfUnreapedChildren > 0 ? 10 : -1;
+        }
+
+        // call callbacks without lock, so they can start new processes
+        for(ChildProcess* child : finishedChildren)
+        {
+            ProcessResult result;
+            result.exitStatus = child->exitStatus;
+            result.success = child->exitStatus == 0;
+            result.processOutput = child->output;
+
+            child->callback(result);
+            delete child;
+        }
+    }
+}
+
+/**
+ * @brief read all available output of a process. The lock of the reactor must be hold.
+ *
+ * @param child process to read from
+ */
+void
+ProcessReactor::readOutput(ChildProcess* child)
+{
+    if(child->outputClosed) {
+        return;
+    }
+
+    char buffer[64 * 1024];
+    while(true)
+    {
+        const ssize_t readSize = read(child->outputFd, buffer, sizeof(buffer));
+        if(readSize > 0)
+        {
+            child->output.append(buffer, static_cast<uint64_t>(readSize));
+            continue;
+        }
+
+        if(readSize < 0
+                && (errno == EAGAIN || errno == EINTR))
+        {
+            return;
+        }
+
+        // end of output or error
+        closeOutput(child);
+        return;
+    }
+}
+
+/**
+ * @brief close the output-pipe of a process. The lock of the reactor must be hold.
+ *
+ * @param child process
+ */
+void
+ProcessReactor::closeOutput(ChildProcess* child)
+{
+    if(child->outputClosed) {
+        return;
+    }
+
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, child->outputFd, nullptr);
+    m_fdToChild.erase(child->outputFd);
+    close(child->outputFd);
+    child->outputClosed = true;
+}
+
+/**
+ * @brief collect the exit-status of an exited process without waiting for processes, which
+ *        are still running. The lock of the reactor must be hold.
+ *
+ * @param child process
+ */
+void
+ProcessReactor::reapChild(ChildProcess* child)
+{
+    int status = 0;
+    pid_t result = 0;
+    do {
+        result = waitpid(child->pid, &status, WNOHANG);
+    }
+    while(result < 0 && errno == EINTR);
+
+    if(result == 0) {
+        return;
+    }
+
+    if(result > 0)
+    {
+        if(WIFEXITED(status)) {
+            child->exitStatus = WEXITSTATUS(status);
+        } else {
+            child->exitStatus = 128 + WTERMSIG(status);
+        }
+    }
+    else
+    {
+        child->exitStatus = 1;
+    }
+
+    child->exited = true;
+
+    if(child->pidFd >= 0)
+    {
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, child->pidFd, nullptr);
+        m_fdToChild.erase(child->pidFd);
+        close(child->pidFd);
+        child->pidFd = -1;
+    }
+}
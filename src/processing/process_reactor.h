@@ -0,0 +1,76 @@
+/**
+ * @file        process_reactor.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef PROCESS_REACTOR_H
+#define PROCESS_REACTOR_H
+
+#include <common.h>
+
+#include <functional>
+
+class ProcessReactor
+{
+public:
+    static ProcessReactor* getInstance();
+
+    bool startProcess(const std::string &command,
+                      const std::function<void(const ProcessResult&)> &callback,
+                      std::string &errorMessage);
+    ProcessResult runProcess(const std::string &command);
+
+    uint64_t getNumberOfRunningProcesses();
+    void killAll(const int signal);
+
+private:
+    struct ChildProcess
+    {
+        pid_t pid = 0;
+        int pidFd = -1;
+        int outputFd = -1;
+        bool exited = false;
+        bool outputClosed = false;
+        int exitStatus = 0;
+        std::string output = "";
+        std::function<void(const ProcessResult&)> callback;
+    };
+
+    ProcessReactor();
+
+    static ProcessReactor* m_instance;
+
+    int m_epollFd = -1;
+    std::thread* m_thread = nullptr;
+    std::mutex m_lock;
+    std::map<int, ChildProcess*> m_fdToChild;
+    std::map<pid_t, ChildProcess*> m_children;
+    uint64_t m_numberOfUnreapedChildren = 0;
+
+    void run();
+    void readOutput(ChildProcess* child);
+    void closeOutput(ChildProcess* child);
+    void reapChild(ChildProcess* child);
+};
+
+ProcessResult runProcess(const std::string &command);
+
+#endif // PROCESS_REACTOR_H
@@ -0,0 +1,294 @@
+/**
+ * @file        resource_limits.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "resource_limits.h"
+
+#include <processing/semaphore.h>
+
+#include <libKitsunemimiCommon/common_methods/string_methods.h>
+#include <libKitsunemimiPersistence/logger/logger.h>
+
+ResourceLimits* ResourceLimits::m_instance = nullptr;
+
+/**
+ * @brief constructor with the default-limits for resources, which can not be used in parallel
+ *        without limit
+ */
+ResourceLimits::ResourceLimits()
+{
+    // apt can only be used once at the same time because of the dpkg-lock
+    m_limits.insert(std::make_pair("apt", 1));
+    // copy is limited by the disc
+    m_limits.insert(std::make_pair("path.copy", 4));
+    // number of connections to the same remote host
+    m_limits.insert(std::make_pair("per_host", 8));
+}
+
+/**
+ * @brief get instance of the resource-limits, which are shared by all threads
+ *
+ * @return pointer to the resource-limits
+ */
+ResourceLimits*
+ResourceLimits::getInstance()
+{
+    static std::mutex instanceLock;
+    std::lock_guard<std::mutex> guard(instanceLock);
+
+    if(m_instance == nullptr) {
+        m_instance = new ResourceLimits();
+    }
+
+    return m_instance;
+}
+
+/**
+ * @brief define or override a limit with a string like "apt=1" or "path.copy=4". The name
+ *        "per_host" defines the limit for each remote host.
+ *
+ * @param definition definition of the limit
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if the definition is invalid, else true
+ */
+bool
+ResourceLimits::setLimit(const std::string &definition,
+                         std::string &errorMessage)
+{
+    std::string name = "";
+    uint32_t limit = 0;
+    if(parseLimit(definition, name, limit, errorMessage) == false) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_limits[name] = limit;
+
+    return true;
+}
+
+/**
+ * @brief wait until the resource, which is used by a blossom, is available. The resource is
+ *        taken from the resource_limit-input of the blossom, or else the limit of the type, the
+ *        per-host-limit of blossoms with an address or the limit of the group of the blossom.
+ *
+ * @param group group-name of the blossom
+ * @param type type-name of the blossom within the group
+ * @param input input-values of the blossom
+ * @param semaphore reference for the taken semaphore, which is nullptr, if the blossom is not
+ *                  limited
+ * @param errorMessage reference for error-message
+ * @param priority priority of the blossom, when waiting for the resource
+ *
+ * @return false, if the resource_limit-input of the blossom is invalid, else true
+ */
+bool
+ResourceLimits::acquire(const std::string &group,
+                        const std::string &type,
+                        const DataMap &input,
+                        Semaphore* &semaphore,
+                        std::string &errorMessage,
+                        const uint64_t priority)
+{
+    semaphore = nullptr;
+    if(getSemaphore(group, type, input, semaphore, errorMessage) == false) {
+        return false;
+    }
+
+    if(semaphore != nullptr) {
+        semaphore->acquire(priority);
+    }
+
+    return true;
+}
+
+/**
+ * @brief give a taken resource back
+ *
+ * @param semaphore semaphore, which was returned by acquire
+ */
+void
+ResourceLimits::release(Semaphore* semaphore)
+{
+    if(semaphore != nullptr) {
+        semaphore->release();
+    }
+}
+
+/**
+ * @brief print the number of blossoms and the sum of their wait-time for each used resource
+ */
+void
+ResourceLimits::logWaitTimes()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    std::map<std::string, Semaphore*>::const_iterator it;
+    for(it = m_semaphores.begin();
+        it != m_semaphores.end();
+        it++)
+    {
+        const uint64_t waitTime = it->second->getWaitTime() / 1000;
+        LOG_INFO("resource-limit " + it->first
+                 + " (" + std::to_string(it->second->getCount()) + "): "
+                 + std::to_string(it->second->getNumberOfAcquires()) + " blossoms, "
+                 + std::to_string(waitTime) + " ms waited");
+    }
+}
+
+/**
+ * @brief parse a string like "apt=1"
+ *
+ * @param definition string to parse
+ * @param name reference for the name of the resource
+ * @param limit reference for the limit
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if the definition is invalid, else true
+ */
+bool
+ResourceLimits::parseLimit(const std::string &definition,
+                           std::string &name,
+                           uint32_t &limit,
+                           std::string &errorMessage)
+{
+    std::vector<std::string> pair;
+    Kitsunemimi::splitStringByDelimiter(pair, definition, '=');
+    if(pair.size() != 2
+            || pair.at(0) == ""
+            || pair.at(1).find_first_not_of("0123456789") != std::string::npos
+            || pair.at(1) == ""
+            || pair.at(1).size() > 9
+            || std::stoul(pair.at(1)) == 0)
+    {
+        errorMessage = "'" + definition + "' is not a valid resource-limit, which must have "
+                       "the form <name>=<number greater than 0>";
+        return false;
+    }
+
+    name = pair.at(0);
+    limit = static_cast<uint32_t>(std::stoul(pair.at(1)));
+
+    return true;
+}
+
+/**
+ * @brief get the semaphore of the resource, which is used by a blossom, and create it, if not
+ *        exist
+ *
+ * @param group group-name of the blossom
+ * @param type type-name of the blossom within the group
+ * @param input input-values of the blossom
+ * @param semaphore reference for the semaphore, which is nullptr, if the blossom is not limited
+ * @param errorMessage reference for error-message
+ *
+ * @return false, if the resource_limit-input of the blossom is invalid, else true
+ */
+bool
+ResourceLimits::getSemaphore(const std::string &group,
+                             const std::string &type,
+                             const DataMap &input,
+                             Semaphore* &semaphore,
+                             std::string &errorMessage)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    std::string name = "";
+    uint32_t limit = 0;
+
+    // override by the blossom itself, which is either only the name of an existing resource
+    // or a new resource with its limit
+    const std::string override = input.getStringByKey("resource_limit");
+    if(override != "")
+    {
+        if(override.find('=') == std::string::npos)
+        {
+            if(m_limits.find(override) == m_limits.end())
+            {
+                errorMessage = "resource-limit '" + override + "' is not defined, so it must "
+                               "be defined with the form <name>=<number>";
+                return false;
+            }
+            name = override;
+        }
+        else
+        {
+            if(parseLimit(override, name, limit, errorMessage) == false) {
+                return false;
+            }
+
+            std::map<std::string, uint32_t>::const_iterator existingIt;
+            existingIt = m_limits.find(name);
+            if(existingIt == m_limits.end())
+            {
+                m_limits.insert(std::make_pair(name, limit));
+            }
+            else if(existingIt->second != limit)
+            {
+                errorMessage = "resource-limit '" + name + "' is already defined with the "
+                               "limit " + std::to_string(existingIt->second) + " and not "
+                               + std::to_string(limit);
+                return false;
+            }
+        }
+    }
+
+    // default-limits of the blossom, where all blossoms with an address share the limit of the
+    // remote host, independent of their group
+    const std::string address = input.getStringByKey("address");
+    if(name == "")
+    {
+        if(m_limits.find(group + "." + type) != m_limits.end()) {
+            name = group + "." + type;
+        } else if(address != "" && m_limits.find("per_host") != m_limits.end()) {
+            name = "per_host";
+        } else if(m_limits.find(group) != m_limits.end()) {
+            name = group;
+        }
+    }
+
+    std::map<std::string, uint32_t>::const_iterator limitIt;
+    limitIt = m_limits.find(name);
+    if(limitIt == m_limits.end()) {
+        return true;
+    }
+
+    // the per-host-limit has one semaphore for each host
+    std::string semaphoreName = name;
+    if(name == "per_host") {
+        semaphoreName += ":" + address;
+    }
+
+    std::map<std::string, Semaphore*>::const_iterator it;
+    it = m_semaphores.find(semaphoreName);
+    if(it != m_semaphores.end())
+    {
+        semaphore = it->second;
+        return true;
+    }
+
+    semaphore = new Semaphore(limitIt->second);
+    m_semaphores.insert(std::make_pair(semaphoreName, semaphore));
+
+    return true;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file        resource_limits.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef RESOURCE_LIMITS_H
+#define RESOURCE_LIMITS_H
+
+#include <common.h>
+
+class Semaphore;
+
+class ResourceLimits
+{
+public:
+    static ResourceLimits* getInstance();
+
+    bool setLimit(const std::string &definition, std::string &errorMessage);
+
+    bool acquire(const std::string &group,
+                 const std::string &type,
+                 const DataMap &input,
+                 Semaphore* &semaphore,
+                 std::string &errorMessage,
+                 const uint64_t priority = 0);
+    void release(Semaphore* semaphore);
+
+    void logWaitTimes();
+
+private:
+    ResourceLimits();
+
+    static ResourceLimits* m_instance;
+
+    std::mutex m_lock;
+    std::map<std::string, uint32_t> m_limits;
+    std::map<std::string, Semaphore*> m_semaphores;
+
+    bool parseLimit(const std::string &definition,
+                    std::string &name,
+                    uint32_t &limit,
+                    std::string &errorMessage);
+    bool getSemaphore(const std::string &group,
+                      const std::string &type,
+                      const DataMap &input,
+                      Semaphore* &semaphore,
+                      std::string &errorMessage);
+};
+
+#endif // RESOURCE_LIMITS_H
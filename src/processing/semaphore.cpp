@@ -0,0 +1,126 @@
+/**
+ * @file        semaphore.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "semaphore.h"
+
+#include <chrono>
+
+/**
+ * @brief constructor
+ *
+ * @param count maximum number of threads, which can hold the semaphore at the same time
+ */
+Semaphore::Semaphore(const uint32_t count)
+    : m_count(std::max(count, 1u)),
+      m_available(std::max(count, 1u))
+{
+    m_numberOfAcquires = 0;
+    m_waitTime = 0;
+}
+
+/**
+ * @brief wait until a slot of the semaphore is free and take it. Free slots are given to the
+ *        waiting thread with the highest priority first and to the longest waiting thread
+ *        within the same priority.
+ *
+ * @param priority priority of the caller, like the expected duration of the blossom
+ */
+void
+Semaphore::acquire(const uint64_t priority)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    // the highest entry of the set is the next one, so earlier tickets get higher values
+    const std::pair<uint64_t, uint64_t> waiter(priority, UINT64_MAX - m_nextTicket);
+    m_nextTicket++;
+    m_waiting.insert(waiter);
+
+    m_cv.wait(lock, [this, &waiter]
+    {
+        return m_available > 0
+               && *m_waiting.rbegin() == waiter;
+    });
+    m_waiting.erase(waiter);
+    m_available--;
+    const bool moreAvailable = m_available > 0 && m_waiting.size() > 0;
+    lock.unlock();
+
+    // wake up the next waiting thread, if there is still a free slot
+    if(moreAvailable) {
+        m_cv.notify_all();
+    }
+
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    const uint64_t waitTime = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+    m_waitTime.fetch_add(waitTime);
+    m_numberOfAcquires.fetch_add(1);
+}
+
+/**
+ * @brief give a slot back to the semaphore
+ */
+void
+Semaphore::release()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_available++;
+    }
+    m_cv.notify_all();
+}
+
+/**
+ * @brief get maximum number of slots of the semaphore
+ *
+ * @return number of slots
+ */
+uint32_t
+Semaphore::getCount() const
+{
+    return m_count;
+}
+
+/**
+ * @brief get number of successful acquires of the semaphore
+ *
+ * @return number of acquires
+ */
+uint64_t
+Semaphore::getNumberOfAcquires() const
+{
+    return m_numberOfAcquires;
+}
+
+/**
+ * @brief get sum of the time, which all threads have waited for the semaphore
+ *
+ * @return wait-time in microseconds
+ */
+uint64_t
+Semaphore::getWaitTime() const
+{
+    return m_waitTime;
+}
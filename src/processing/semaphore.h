@@ -0,0 +1,55 @@
+/**
+ * @file        semaphore.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#include <common.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <set>
+
+class Semaphore
+{
+public:
+    Semaphore(const uint32_t count);
+
+    void acquire(const uint64_t priority = 0);
+    void release();
+    uint32_t getCount() const;
+    uint64_t getNumberOfAcquires() const;
+    uint64_t getWaitTime() const;
+
+private:
+    const uint32_t m_count;
+    uint32_t m_available;
+    std::mutex m_lock;
+    std::condition_variable m_cv;
+    std::set<std::pair<uint64_t, uint64_t>> m_waiting;
+    uint64_t m_nextTicket = 0;
+    std::atomic<uint64_t> m_numberOfAcquires;
+    std::atomic<uint64_t> m_waitTime;
+};
+
+#endif // SEMAPHORE_H
@@ -0,0 +1,427 @@
+/**
+ * @file        thread_pool.cpp
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include "thread_pool.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <sched.h>
+
+ThreadPool* ThreadPool::m_instance = nullptr;
+thread_local ThreadPool* ThreadPool::m_currentPool = nullptr;
+thread_local uint32_t ThreadPool::m_currentWorker = 0;
+
+static std::mutex instanceLock;
+
+/**
+ * @brief get global thread-pool, which is shared by all parts of the tool, which want to run
+ *        tasks in background
+ *
+ * @return pointer to the global thread-pool
+ */
+ThreadPool*
+ThreadPool::getInstance()
+{
+    std::lock_guard<std::mutex> guard(instanceLock);
+
+    if(m_instance == nullptr) {
+        m_instance = new ThreadPool(getDefaultNumberOfThreads());
+    }
+
+    return m_instance;
+}
+
+/**
+ * @brief create the global thread-pool with a specific number of threads. This has to be
+ *        called before the first call of getInstance.
+ *
+ * @param numberOfThreads number of worker-threads of the pool
+ */
+void
+ThreadPool::initInstance(const uint32_t numberOfThreads)
+{
+    std::lock_guard<std::mutex> guard(instanceLock);
+
+    if(m_instance == nullptr) {
+        m_instance = new ThreadPool(std::max(numberOfThreads, 1u));
+    }
+}
+
+/**
+ * @brief get the number of cpu-cores, which can be used by this process. This respects the
+ *        cpu-affinity and the cpu-quota of the cgroup (v1 and v2), so within a container only
+ *        the cores, which are assigned to the container, are counted.
+ *
+ * @return number of usable cpu-cores
+ */
+uint32_t
+ThreadPool::getDefaultNumberOfThreads()
+{
+    uint32_t numberOfCpus = std::thread::hardware_concurrency();
+
+    // cpu-affinity
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if(sched_getaffinity(0, sizeof(cpuSet), &cpuSet) == 0) {
+        numberOfCpus = static_cast<uint32_t>(CPU_COUNT(&cpuSet));
+    }
+
+    // cpu-quota of cgroup v2 with the format "<quota> <period>" or "max <period>"
+    double quota = -1.0;
+    double period = 0.0;
+    std::ifstream cgroupV2("/sys/fs/cgroup/cpu.max");
+    std::string quotaString;
+    if(cgroupV2 >> quotaString >> period)
+    {
+        if(quotaString != "max") {
+            quota = std::stod(quotaString);
+        }
+    }
+    else
+    {
+        // cpu-quota of cgroup v1, where -1 means no limit
+        std::ifstream quotaFile("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+        std::ifstream periodFile("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+        if((quotaFile >> quota && periodFile >> period) == false) {
+            quota = -1.0;
+        }
+    }
+
+    if(quota > 0.0
+            && period > 0.0)
+    {
+        const uint32_t quotaCpus = static_cast<uint32_t>(std::ceil(quota / period));
+        numberOfCpus = std::min(numberOfCpus, quotaCpus);
+    }
+
+    return std::max(numberOfCpus, 1u);
+}
+
+/**
+ * @brief constructor
+ *
+ * @param numberOfThreads number of worker-threads of the pool
+ */
+ThreadPool::ThreadPool(const uint32_t numberOfThreads)
+{
+    m_queuedTasks = 0;
+    m_nextQueue = 0;
+
+    for(uint32_t i = 0; i < numberOfThreads; i++) {
+        m_queues.push_back(new WorkerQueue());
+    }
+
+    for(uint32_t i = 0; i < numberOfThreads; i++) {
+        m_threads.push_back(new std::thread(&ThreadPool::run, this, i));
+    }
+}
+
+/**
+ * @brief destructor
+ */
+ThreadPool::~ThreadPool()
+{
+    m_lock.lock();
+    m_abort = true;
+    m_lock.unlock();
+    m_cv.notify_all();
+
+    for(std::thread* thread : m_threads)
+    {
+        thread->join();
+        delete thread;
+    }
+
+    for(WorkerQueue* queue : m_queues) {
+        delete queue;
+    }
+}
+
+/**
+ * @brief add new task to the pool. Tasks, which are added by a worker-thread of the pool, are
+ *        put into the own queue of this worker. Tasks of other threads are distributed over
+ *        the queues of all workers.
+ *
+ * @param task task to process
+ */
+void
+ThreadPool::addTask(const std::function<void()> &task)
+{
+    uint32_t queueId = 0;
+    if(m_currentPool == this) {
+        queueId = m_currentWorker;
+    } else {
+        queueId = m_nextQueue.fetch_add(1) % m_queues.size();
+    }
+
+    WorkerQueue* queue = m_queues.at(queueId);
+    queue->lock.lock();
+    queue->tasks.push_back(task);
+    queue->lock.unlock();
+
+    m_queuedTasks.fetch_add(1);
+
+    // lock to avoid, that a worker misses the notification between its check and its wait
+    m_lock.lock();
+    m_lock.unlock();
+    m_cv.notify_one();
+}
+
+/**
+ * @brief run a list of tasks within the pool and wait until all of them are finished. The
+ *        calling thread processes tasks of the same list too while waiting, so this can also
+ *        be used within tasks of the pool without blocking all worker-threads. It never runs
+ *        foreign tasks of the queues, because they could wait for a resource, which is already
+ *        hold by the caller further up on the same stack.
+ *
+ * @param tasks list of tasks to process
+ */
+void
+ThreadPool::runTasks(const std::vector<std::function<void()>> &tasks)
+{
+    struct TaskGroup
+    {
+        std::vector<std::function<void()>> tasks;
+        std::atomic<uint64_t> nextTask;
+        std::atomic<uint64_t> openTasks;
+        std::mutex lock;
+        std::condition_variable cv;
+
+        // take the next task of the group, which was not taken by another thread
+        bool runNext()
+        {
+            const uint64_t taskId = nextTask.fetch_add(1);
+            if(taskId >= tasks.size()) {
+                return false;
+            }
+
+            tasks.at(taskId)();
+            if(openTasks.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                cv.notify_all();
+            }
+
+            return true;
+        }
+    };
+
+    std::shared_ptr<TaskGroup> group = std::make_shared<TaskGroup>();
+    group->tasks = tasks;
+    group->nextTask = 0;
+    group->openTasks = tasks.size();
+
+    // the queued entries only take the next task of the group, so they do nothing, if the
+    // calling thread has already processed all tasks
+    for(uint64_t i = 0; i < tasks.size(); i++) {
+        addTask([group]() { group->runNext(); });
+    }
+
+    // help processing the tasks of the group and wait for the ones of the other threads
+    while(group->runNext()) {}
+
+    std::unique_lock<std::mutex> lock(group->lock);
+    group->cv.wait(lock, [group] { return group->openTasks == 0; });
+}
+
+/**
+ * @brief run a loop-body for a range of indexes within the pool and wait until all iterations
+ *        are finished. The body is shared by all tasks and not copied, so it must only write
+ *        into memory, which belongs to the index of the current iteration.
+ *
+ * @param numberOfIterations number of iterations
+ * @param body loop-body, which gets the index of the iteration
+ */
+void
+ThreadPool::parallelFor(const uint64_t numberOfIterations,
+                        const std::function<void(const uint64_t)> &body)
+{
+    parallelForChunks(numberOfIterations,
+                      [&body](const uint64_t, const uint64_t start, const uint64_t end)
+    {
+        for(uint64_t index = start; index < end; index++) {
+            body(index);
+        }
+    });
+}
+
+/**
+ * @brief get the number of chunks, into which parallelForChunks splits a loop
+ *
+ * @param numberOfIterations number of iterations
+ *
+ * @return number of chunks
+ */
+uint64_t
+ThreadPool::getNumberOfChunks(const uint64_t numberOfIterations) const
+{
+    // multiple chunks per thread to balance iterations with different durations
+    const uint64_t numberOfThreads = m_threads.size() + 1;
+    return std::min(numberOfIterations, numberOfThreads * 4);
+}
+
+/**
+ * @brief run a loop in chunks of iterations within the pool and wait until all chunks are
+ *        finished. Instead of one task per iteration, there is only one task per thread, which
+ *        takes chunks from a shared counter, until all chunks are taken. Chunks cover
+ *        continuous ranges of indexes in the order of their ids, so results, which are
+ *        collected per chunk without any lock, can be merged afterwards in the order of the
+ *        chunk-ids to get a deterministic order of the iterations.
+ *
+ * @param numberOfIterations number of iterations
+ * @param body loop-body, which gets the id of the chunk, the first index of the chunk and the
+ *             index behind the last index of the chunk
+ */
+void
+ThreadPool::parallelForChunks(const uint64_t numberOfIterations,
+                              const std::function<void(const uint64_t,
+                                                       const uint64_t,
+                                                       const uint64_t)> &body)
+{
+    if(numberOfIterations == 0) {
+        return;
+    }
+
+    const uint64_t numberOfChunks = getNumberOfChunks(numberOfIterations);
+    const uint64_t chunkSize = numberOfIterations / numberOfChunks;
+    const uint64_t chunksWithOneMore = numberOfIterations % numberOfChunks;
+    std::atomic<uint64_t> nextChunk(0);
+
+    const uint64_t numberOfTasks = std::min(static_cast<uint64_t>(m_threads.size() + 1),
+                                            numberOfChunks);
+    std::vector<std::function<void()>> tasks;
+    for(uint64_t i = 0; i < numberOfTasks; i++)
+    {
+        tasks.push_back([&]()
+        {
+            while(true)
+            {
+                const uint64_t chunkId = nextChunk.fetch_add(1);
+                if(chunkId >= numberOfChunks) {
+                    return;
+                }
+
+                // the first chunks get one iteration more, if the iterations are not divisible
+                const uint64_t start = chunkId * chunkSize + std::min(chunkId, chunksWithOneMore);
+                uint64_t end = start + chunkSize;
+                if(chunkId < chunksWithOneMore) {
+                    end++;
+                }
+
+                body(chunkId, start, end);
+            }
+        });
+    }
+
+    runTasks(tasks);
+}
+
+/**
+ * @brief take the next task without waiting. A worker takes the newest task of its own queue
+ *        first, because its data is most likely still in the cache, and steals the oldest
+ *        task of the other queues, if its own queue is empty.
+ *
+ * @param task reference for the task
+ *
+ * @return false, if all queues are empty, else true
+ */
+bool
+ThreadPool::getTask(std::function<void()> &task)
+{
+    if(m_queuedTasks == 0) {
+        return false;
+    }
+
+    const uint32_t numberOfQueues = static_cast<uint32_t>(m_queues.size());
+    uint32_t ownQueue = 0;
+    if(m_currentPool == this) {
+        ownQueue = m_currentWorker;
+    }
+
+    for(uint32_t i = 0; i < numberOfQueues; i++)
+    {
+        WorkerQueue* queue = m_queues.at((ownQueue + i) % numberOfQueues);
+        std::lock_guard<std::mutex> guard(queue->lock);
+        if(queue->tasks.empty()) {
+            continue;
+        }
+
+        if(i == 0 && m_currentPool == this)
+        {
+            task = queue->tasks.back();
+            queue->tasks.pop_back();
+        }
+        else
+        {
+            task = queue->tasks.front();
+            queue->tasks.pop_front();
+        }
+
+        m_queuedTasks.fetch_sub(1);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief get number of worker-threads of the pool
+ *
+ * @return number of threads
+ */
+uint32_t
+ThreadPool::getNumberOfThreads() const
+{
+    return static_cast<uint32_t>(m_threads.size());
+}
+
+/**
+ * @brief loop of the worker-threads to process the queued tasks
+ *
+ * @param workerId id of the worker, which is also the id of its own queue
+ */
+void
+ThreadPool::run(const uint32_t workerId)
+{
+    m_currentPool = this;
+    m_currentWorker = workerId;
+
+    while(true)
+    {
+        std::function<void()> task;
+        if(getTask(task))
+        {
+            task();
+            continue;
+        }
+
+        // wait for next task
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_cv.wait(lock, [this] { return m_abort || m_queuedTasks > 0; });
+        if(m_abort) {
+            return;
+        }
+    }
+}
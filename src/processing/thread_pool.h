@@ -0,0 +1,78 @@
+/**
+ * @file        thread_pool.h
+ *
+ * @author      Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright   Apache License Version 2.0
+ *
+ *      Copyright 2019 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <common.h>
+
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+#include <deque>
+
+class ThreadPool
+{
+public:
+    static ThreadPool* getInstance();
+    static void initInstance(const uint32_t numberOfThreads);
+    static uint32_t getDefaultNumberOfThreads();
+
+    ThreadPool(const uint32_t numberOfThreads);
+    ~ThreadPool();
+
+    void addTask(const std::function<void()> &task);
+    void runTasks(const std::vector<std::function<void()>> &tasks);
+    void parallelFor(const uint64_t numberOfIterations,
+                     const std::function<void(const uint64_t)> &body);
+    uint64_t getNumberOfChunks(const uint64_t numberOfIterations) const;
+    void parallelForChunks(const uint64_t numberOfIterations,
+                           const std::function<void(const uint64_t,
+                                                    const uint64_t,
+                                                    const uint64_t)> &body);
+    uint32_t getNumberOfThreads() const;
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    static ThreadPool* m_instance;
+    static thread_local ThreadPool* m_currentPool;
+    static thread_local uint32_t m_currentWorker;
+
+    std::vector<std::thread*> m_threads;
+    std::vector<WorkerQueue*> m_queues;
+    std::atomic<uint64_t> m_queuedTasks;
+    std::atomic<uint32_t> m_nextQueue;
+    std::mutex m_lock;
+    std::condition_variable m_cv;
+    bool m_abort = false;
+
+    void run(const uint32_t workerId);
+    bool getTask(std::function<void()> &task);
+};
+
+#endif // THREAD_POOL_H
@@ -28,7 +28,18 @@
 
 #include <libKitsunemimiPersistence/logger/logger.h>
 #include <libKitsunemimiPersistence/files/file_methods.h>
+#include <libKitsunemimiPersistence/files/text_file.h>
 
+#include <agent/agent_server.h>
+#include <caches/ini_cache.h>
+#include <processing/auto_scheduler.h>
+#include <processing/process_reactor.h>
+#include <processing/blossom_wrapper.h>
+#include <processing/duration_history.h>
+#include <processing/fail_fast.h>
+#include <processing/resource_limits.h>
+
+#include <blossoms/agent_blossoms.h>
 #include <blossoms/apt_blossoms.h>
 #include <blossoms/ini_blossoms.h>
 #include <blossoms/path_blossoms.h>
@@ -37,6 +48,8 @@
 #include <blossoms/template_blossoms.h>
 #include <blossoms/text_blossoms.h>
 
+#include <chrono>
+
 SakuraRoot* SakuraRoot::m_root = nullptr;
 std::string SakuraRoot::m_executablePath = "";
 
@@ -50,6 +63,14 @@ SakuraRoot::SakuraRoot(const std::string &executablePath)
     // initialzed static variables
     m_root = this;
     m_executablePath = executablePath;
+
+    // the binary is copied to remote hosts by the subtree-blossom of the ssh-group, so the
+    // absolute path is required and not the path of the call
+    boost::system::error_code ec;
+    const bfs::path selfPath = bfs::read_symlink("/proc/self/exe", ec);
+    if(ec.failed() == false) {
+        m_executablePath = selfPath.string();
+    }
 }
 
 /**
@@ -65,36 +86,229 @@ SakuraRoot::~SakuraRoot()
  * @param inputPath initial path to parse
  * @param initialValues key-value-pairs to override the values of the initial file
  * @param dryRun true to start a run with parsing and validating, but without execution
+ * @param autoParallel true to run independent blossoms automatically in background
  *
  * @return true if successful, else false
  */
 bool
 SakuraRoot::startProcess(const std::string &inputPath,
                          const DataMap &initialValues,
-                         const bool dryRun)
+                         const bool dryRun,
+                         const bool autoParallel)
 {
     initBlossoms();
+    AutoScheduler::getInstance()->setEnabled(autoParallel);
 
     LOG_INFO(ASCII_LOGO, PINK_COLOR);
 
+    // the duration of the whole run is stored like a blossom within the history
+    DurationHistory* history = DurationHistory::getInstance();
+    const std::string runKey = inputPath + "\trun\tlocalhost";
+    const uint64_t predictedMakespan = history->getExpectedDuration(runKey);
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::string errorMessage = "";
+    const bool result = processTree(inputPath, initialValues, dryRun, errorMessage);
+
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    const uint64_t makespan = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+
+    ResourceLimits::getInstance()->logWaitTimes();
+
+    if(history->isEnabled()
+            && dryRun == false)
+    {
+        if(predictedMakespan == 0) {
+            LOG_INFO("makespan: " + std::to_string(makespan) + " ms (no prediction yet)");
+        } else {
+            LOG_INFO("makespan: predicted " + std::to_string(predictedMakespan) + " ms, "
+                     "actual " + std::to_string(makespan) + " ms");
+        }
+
+        if(result) {
+            history->addDuration(runKey, makespan);
+        }
+
+        std::string historyError = "";
+        if(history->save(historyError) == false) {
+            LOG_WARNING("failed to write duration-history: " + historyError);
+        }
+    }
+
+    if(result) {
+        LOG_INFO("finish", GREEN_COLOR);
+    } else {
+        LOG_ERROR(errorMessage);
+    }
+
+    return result;
+}
+
+/**
+ * @brief escape a string to be used as value within a json-string
+ *
+ * @param input string to escape
+ *
+ * @return escaped string
+ */
+const std::string
+escapeJsonString(const std::string &input)
+{
+    std::string result = "";
+    for(const char c : input)
+    {
+        switch(c)
+        {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(c) >= 0x20) {
+                    result += c;
+                }
+                break;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief start rollout-process as agent on a remote host, which was triggered by the
+ *        subtree-blossom of the ssh-group
+ *
+ * @param inputPath path to the transfered subtree
+ * @param valuesPath path to the json-file with the initial values of the subtree
+ *
+ * @return true if successful, else false
+ */
+bool
+SakuraRoot::startAgentProcess(const std::string &inputPath,
+                              const std::string &valuesPath)
+{
+    initBlossoms();
+
+    std::string errorMessage = "";
+    bool result = false;
+    DataMap initialValues;
+
+    // read and parse initial values
+    std::string valuesContent = "";
+    if(Kitsunemimi::Persistence::readFile(valuesContent, valuesPath, errorMessage))
+    {
+        JsonItem parsedValues;
+        if(parsedValues.parse(valuesContent, errorMessage))
+        {
+            DataItem* content = parsedValues.getItemContent();
+            if(content != nullptr
+                    && content->isMap())
+            {
+                initialValues = *content->toMap();
+                result = true;
+            }
+            else
+            {
+                errorMessage = "initial values of the agent are not a json-map";
+            }
+        }
+    }
+
+    // process subtree, where the outputs of all blossoms are given back to the caller
+    if(result)
+    {
+        BlossomWrapper::enableOutputCollection();
+        result = processTree(inputPath, initialValues, false, errorMessage);
+    }
+
+    // print result as last line, so the caller can find it within the complete output
+    std::cout << AGENT_RESULT_PREFIX
+              << "{\"success\":" << (result ? "true" : "false")
+              << ",\"error_message\":\"" << escapeJsonString(errorMessage) << "\""
+              << ",\"output\":" << BlossomWrapper::getCollectedOutputs() << "}"
+              << std::endl;
+
+    return result;
+}
+
+/**
+ * @brief run as persistent agent, which processes blossom-requests of controllers
+ *
+ * @param address address to listen on (tcp:<ip>:<port> or unix:<path>)
+ *
+ * @return false, if the server couldn't be started
+ */
+bool
+SakuraRoot::startAgentServer(const std::string &address)
+{
+    initBlossoms();
+
+    std::string errorMessage = "";
+    AgentServer server;
+    if(server.startServer(address, errorMessage) == false)
+    {
+        LOG_ERROR(errorMessage);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief parse and process a sakura-file
+ *
+ * @param inputPath initial path to parse
+ * @param initialValues key-value-pairs to override the values of the initial file
+ * @param dryRun true to start a run with parsing and validating, but without execution
+ * @param errorMessage reference for error-message
+ *
+ * @return true if successful, else false
+ */
+bool
+SakuraRoot::processTree(const std::string &inputPath,
+                        const DataMap &initialValues,
+                        const bool dryRun,
+                        std::string &errorMessage)
+{
     // set default-file in case that a directory instead of a file was selected
     std::string treeFile = inputPath;
     if(bfs::is_directory(treeFile)) {
         treeFile = treeFile + "/root.sakura";
     }
 
+    FailFast* failFast = FailFast::getInstance();
+    failFast->reset();
+
     // process
-    std::string errorMessage = "";
     SakuraLangInterface* interface = SakuraLangInterface::getInstance();
-    const bool result = interface->processFiles(treeFile,
-                                                initialValues,
-                                                dryRun,
-                                                errorMessage);
+    bool result = interface->processFiles(treeFile,
+                                          initialValues,
+                                          dryRun,
+                                          errorMessage);
 
-    if(result) {
-        LOG_INFO("finish", GREEN_COLOR);
-    } else {
-        LOG_ERROR(errorMessage);
+    // wait for the blossoms, which are still running in background
+    std::string schedulerError = "";
+    if(AutoScheduler::getInstance()->waitForAll(schedulerError) == false)
+    {
+        errorMessage += schedulerError;
+        result = false;
+    }
+
+    // the errors of the canceled branches are only follow-up errors, so the first error is
+    // the one, which has to be reported
+    if(failFast->isCanceled()) {
+        errorMessage = failFast->getFirstError();
+    }
+
+    // write all ini-changes, which are still only in the cache, into their files. This is
+    // also done after a failed run to not lose changes of the successful blossoms.
+    std::string flushError = "";
+    if(IniCache::getInstance()->flushAll(flushError) == false)
+    {
+        errorMessage += "failed to write ini-files: " + flushError;
+        result = false;
     }
 
     return result;
@@ -106,41 +320,97 @@ SakuraRoot::startProcess(const std::string &inputPath,
 void
 SakuraRoot::initBlossoms()
 {
+    assert(addBlossom("agent", "run", new AgentRunBlossom()));
+
+    assert(addBlossom("apt", "absent", new AptAbsentBlossom()));
+    assert(addBlossom("apt", "latest", new AptLatestBlossom()));
+    assert(addBlossom("apt", "present", new AptPresentBlossom()));
+    assert(addBlossom("apt", "update", new AptUdateBlossom()));
+    assert(addBlossom("apt", "upgrade", new AptUpgradeBlossom()));
+
+    assert(addBlossom("ini_file", "delete", new IniDeleteEntryBlossom()));
+    assert(addBlossom("ini_file", "read", new IniReadEntryBlossom()));
+    assert(addBlossom("ini_file", "set", new IniSetEntryBlossom()));
+
+    assert(addBlossom("path", "chmod", new PathChmodBlossom()));
+    assert(addBlossom("path", "chown", new PathChownBlossom()));
+    assert(addBlossom("path", "copy", new PathCopyBlossom()));
+    assert(addBlossom("path", "delete", new PathDeleteBlossom()));
+    assert(addBlossom("path", "rename", new PathRenameBlossom()));
+
+    assert(addBlossom("template", "create_string", new TemplateCreateStringBlossom()));
+    assert(addBlossom("template", "create_file", new TemplateCreateFileBlossom()));
+    assert(addBlossom("template", "create_remote_file", new TemplateCreateRemoteFileBlossom()));
+    assert(addBlossom("template", "create_tree", new TemplateCreateTreeBlossom()));
+
+    assert(addBlossom("special", "assert", new AssertBlossom()));
+    assert(addBlossom("special", "cmd", new CmdBlossom()));
+    assert(addBlossom("special", "exit", new ExitBlossom()));
+    assert(addBlossom("special", "item_update", new ItemUpdateBlossom()));
+    assert(addBlossom("special", "print", new PrintBlossom()));
+
+    assert(addBlossom("text_file", "append", new TextAppendBlossom()));
+    assert(addBlossom("text_file", "ensure_line", new TextEnsureLineBlossom()));
+    assert(addBlossom("text_file", "read", new TextReadBlossom()));
+    assert(addBlossom("text_file", "replace", new TextReplaceBlossom()));
+    assert(addBlossom("text_file", "write", new TextWriteBlossom()));
+
+    assert(addBlossom("ssh", "file_create", new SshCmdCreateFileBlossom()));
+    assert(addBlossom("ssh", "scp", new SshScpBlossom()));
+    assert(addBlossom("ssh", "cmd", new SshCmdBlossom()));
+    assert(addBlossom("ssh", "facts", new SshFactsBlossom()));
+    assert(addBlossom("ssh", "rolling_subtree", new SshRollingSubtreeBlossom()));
+    assert(addBlossom("ssh", "subtree", new SshSubtreeBlossom()));
+}
+
+/**
+ * @brief register a blossom at the sakura-lang-interface and keep it for direct requests
+ *        by controllers, when running as agent
+ *
+ * @param group group-name of the blossom
+ * @param type type-name of the blossom within the group
+ * @param blossom blossom to register
+ *
+ * @return false, if already registered, else true
+ */
+bool
+SakuraRoot::addBlossom(const std::string &group,
+                       const std::string &type,
+                       SakuraBlossom* blossom)
+{
+    // the wrapper limits the number of blossoms, which are running at the same time
+    BlossomWrapper* wrapper = new BlossomWrapper(blossom, group, type);
+
     SakuraLangInterface* interface = SakuraLangInterface::getInstance();
+    if(interface->addBlossom(group, type, wrapper) == false) {
+        return false;
+    }
+
+    m_blossoms.insert(std::make_pair(group + "/" + type, wrapper));
+
+    return true;
+}
+
+/**
+ * @brief get a registered blossom together with its wrapper, so it runs with the same limits
+ *        and duration-recording like within a tree
+ *
+ * @param group group-name of the blossom
+ * @param type type-name of the blossom within the group
+ *
+ * @return pointer to the wrapped blossom, or nullptr, if not found
+ */
+SakuraBlossom*
+SakuraRoot::getBlossom(const std::string &group,
+                       const std::string &type)
+{
+    std::map<std::string, SakuraBlossom*>::const_iterator it;
+    it = m_blossoms.find(group + "/" + type);
+    if(it == m_blossoms.end()) {
+        return nullptr;
+    }
 
-    assert(interface->addBlossom("apt", "absent", new AptAbsentBlossom()));
-    assert(interface->addBlossom("apt", "latest", new AptLatestBlossom()));
-    assert(interface->addBlossom("apt", "present", new AptPresentBlossom()));
-    assert(interface->addBlossom("apt", "update", new AptUdateBlossom()));
-    assert(interface->addBlossom("apt", "upgrade", new AptUpgradeBlossom()));
-
-    assert(interface->addBlossom("ini_file", "delete", new IniDeleteEntryBlossom()));
-    assert(interface->addBlossom("ini_file", "read", new IniReadEntryBlossom()));
-    assert(interface->addBlossom("ini_file", "set", new IniSetEntryBlossom()));
-
-    assert(interface->addBlossom("path", "chmod", new PathChmodBlossom()));
-    assert(interface->addBlossom("path", "chown", new PathChownBlossom()));
-    assert(interface->addBlossom("path", "copy", new PathCopyBlossom()));
-    assert(interface->addBlossom("path", "delete", new PathDeleteBlossom()));
-    assert(interface->addBlossom("path", "rename", new PathRenameBlossom()));
-
-    assert(interface->addBlossom("template", "create_string", new TemplateCreateStringBlossom()));
-    assert(interface->addBlossom("template", "create_file", new TemplateCreateFileBlossom()));
-
-    assert(interface->addBlossom("special", "assert", new AssertBlossom()));
-    assert(interface->addBlossom("special", "cmd", new CmdBlossom()));
-    assert(interface->addBlossom("special", "exit", new ExitBlossom()));
-    assert(interface->addBlossom("special", "item_update", new ItemUpdateBlossom()));
-    assert(interface->addBlossom("special", "print", new PrintBlossom()));
-
-    assert(interface->addBlossom("text_file", "append", new TextAppendBlossom()));
-    assert(interface->addBlossom("text_file", "read", new TextReadBlossom()));
-    assert(interface->addBlossom("text_file", "replace", new TextReplaceBlossom()));
-    assert(interface->addBlossom("text_file", "write", new TextWriteBlossom()));
-
-    assert(interface->addBlossom("ssh", "file_create", new SshCmdCreateFileBlossom()));
-    assert(interface->addBlossom("ssh", "scp", new SshScpBlossom()));
-    assert(interface->addBlossom("ssh", "cmd", new SshCmdBlossom()));
+    return it->second;
 }
 
 /**
@@ -158,7 +428,7 @@ SakuraRoot::runCommand(const std::string &command,
     LOG_DEBUG("run command: " + command);
 
     // run command
-    Kitsunemimi::ProcessResult processResult = Kitsunemimi::runSyncProcess(command);
+    Kitsunemimi::ProcessResult processResult = runProcess(command);
     if(processResult.success == false)
     {
         errorMessage = processResult.processOutput;
@@ -24,6 +24,7 @@
 #define SAKURA_ROOT_H
 
 #include <common.h>
+#include <blossoms/sakura_blossom.h>
 #include <libKitsunemimiCommon/common_items/table_item.h>
 
 namespace Kitsunemimi
@@ -47,16 +48,30 @@ public:
     // start processing
     bool startProcess(const std::string &inputPath,
                       const DataMap &initialValues,
-                      const bool dryRun = false);
+                      const bool dryRun = false,
+                      const bool autoParallel = false);
+    bool startAgentProcess(const std::string &inputPath,
+                           const std::string &valuesPath);
+    bool startAgentServer(const std::string &address);
 
     bool runCommand(const std::string &command, std::string &errorMessage);
+    SakuraBlossom* getBlossom(const std::string &group, const std::string &type);
 
     // static values
     static SakuraRoot* m_root;
     static std::string m_executablePath;
 
 private:
+    std::map<std::string, SakuraBlossom*> m_blossoms;
+
     void initBlossoms();
+    bool addBlossom(const std::string &group,
+                    const std::string &type,
+                    SakuraBlossom* blossom);
+    bool processTree(const std::string &inputPath,
+                     const DataMap &initialValues,
+                     const bool dryRun,
+                     std::string &errorMessage);
 };
 
 #endif // SAKURA_ROOT_H
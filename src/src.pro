@@ -52,21 +52,55 @@ HEADERS += \
     args.h \
     common.h \
     sakura_root.h \
+    agent/agent_client.h \
+    agent/agent_messages.h \
+    agent/agent_server.h \
+    blossoms/agent_blossoms.h \
     blossoms/apt_blossoms.h \
     blossoms/ini_blossoms.h \
     blossoms/path_blossoms.h \
+    blossoms/sakura_blossom.h \
     blossoms/special_blossoms.h \
     blossoms/ssh_blossoms.h \
     blossoms/template_blossoms.h \
-    blossoms/text_blossoms.h
+    blossoms/text_blossoms.h \
+    caches/ini_cache.h \
+    helper/file_helper.h \
+    processing/append_queue.h \
+    processing/auto_scheduler.h \
+    processing/blossom_wrapper.h \
+    processing/duration_history.h \
+    processing/fail_fast.h \
+    processing/output_bindings.h \
+    processing/process_reactor.h \
+    processing/resource_limits.h \
+    processing/semaphore.h \
+    processing/thread_pool.h
 
 SOURCES += \
     main.cpp \
     sakura_root.cpp \
+    agent/agent_client.cpp \
+    agent/agent_messages.cpp \
+    agent/agent_server.cpp \
+    blossoms/agent_blossoms.cpp \
     blossoms/apt_blossoms.cpp \
     blossoms/ini_blossoms.cpp \
     blossoms/path_blossoms.cpp \
+    blossoms/sakura_blossom.cpp \
     blossoms/speacal_blossom.cpp \
     blossoms/ssh_blossoms.cpp \
     blossoms/template_blossoms.cpp \
-    blossoms/text_blossoms.cpp
+    blossoms/text_blossoms.cpp \
+    caches/ini_cache.cpp \
+    helper/file_helper.cpp \
+    processing/append_queue.cpp \
+    processing/auto_scheduler.cpp \
+    processing/blossom_wrapper.cpp \
+    processing/duration_history.cpp \
+    processing/fail_fast.cpp \
+    processing/output_bindings.cpp \
+    processing/process_reactor.cpp \
+    processing/resource_limits.cpp \
+    processing/semaphore.cpp \
+    processing/thread_pool.cpp